@@ -0,0 +1,52 @@
+//
+// Created by lc06 on 5/5/2023.
+//
+
+#include "Batch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+void Batch::triangulate(const std::vector<double>& coords, const std::vector<uint32_t>& offsets,
+                        std::vector<unsigned int>& triangles, std::vector<uint32_t>& triOffsets) {
+    auto start = std::chrono::steady_clock::now();
+    size_t sets = offsets.empty() ? 0 : offsets.size() - 1;
+
+    // every set gets room for its 2n - 5 triangles
+    std::vector<size_t> slots(sets + 1, 0);
+    for(size_t k = 0; k < sets; ++k) {
+        size_t n = offsets[k + 1] - offsets[k];
+        slots[k + 1] = slots[k] + (n >= 3 ? 3 * (2 * n - 5) : 0);
+    }
+    triangles.resize(slots[sets]);
+    triOffsets.assign(sets + 1, 0);
+
+    size_t ranges = std::min(sets, RANGES_PER_THREAD * pool.size());
+    size_t chunk = ranges == 0 ? 0 : (sets + ranges - 1) / ranges;
+    if(scratch.size() < ranges) scratch.resize(ranges);
+
+    pool.parallelFor(ranges, [&](size_t r) {
+        Scratch& own = scratch[r];
+        for(size_t k = r * chunk; k < std::min(sets, (r + 1) * chunk); ++k) {
+            uint32_t first = offsets[k];
+            own.triangles.clear();
+            own.sweep.triangulate(coords.data() + 2 * first, offsets[k + 1] - first, own.triangles);
+
+            for(size_t i = 0; i < own.triangles.size(); ++i) triangles[slots[k] + i] = own.triangles[i] + first;
+            triOffsets[k + 1] = own.triangles.size();
+        }
+    });
+
+    // close up the slots, the counts become offsets. A set only ever moves left, and std::copy allows that
+    // unless it stays where it is
+    for(size_t k = 0; k < sets; ++k) {
+        uint32_t count = triOffsets[k + 1];
+        triOffsets[k + 1] = triOffsets[k] + count;
+        if(slots[k] != triOffsets[k]) std::copy(triangles.begin() + slots[k], triangles.begin() + slots[k] + count, triangles.begin() + triOffsets[k]);
+    }
+    triangles.resize(triOffsets[sets]);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "batch: " << sets << " sets in " << seconds * 1000. << " ms, " << (seconds > 0. ? sets / seconds : 0.) << " sets/s" << std::endl;
+}
@@ -0,0 +1,46 @@
+//
+// Created by lc06 on 5/5/2023.
+//
+
+#ifndef DELAUNAY_BATCH_H
+#define DELAUNAY_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SweepHull.h"
+#include "ThreadPool.h"
+
+/*
+ * Delaunay triangulation of many independent small point sets, e.g. parcel outlines of 3-200 vertices.
+ *
+ * The sets are dealt to the pool in a few ranges per thread and every range owns one sweep hull and one
+ * triangle buffer, kept between calls: after the first sets have grown them to the largest size seen,
+ * a set costs no heap allocation at all. Each set writes into its own slot of the result, sized for
+ * the 2n - 5 triangles it can have, and the slots are closed up afterwards.
+ */
+class Batch {
+public:
+    explicit Batch(unsigned int threads) : pool(threads) {}
+
+    // set k is the points [offsets[k], offsets[k + 1]) of coords (x, y pairs). Its counterclockwise
+    // triangles, by index into coords, are triangles[triOffsets[k]] up to triangles[triOffsets[k + 1]];
+    // sets of less than three distinct or only collinear points have none. Logs the throughput.
+    void triangulate(const std::vector<double>& coords, const std::vector<uint32_t>& offsets,
+                     std::vector<unsigned int>& triangles, std::vector<uint32_t>& triOffsets);
+
+private:
+    static constexpr size_t RANGES_PER_THREAD = 8;
+
+    struct Scratch {
+        SweepHull<AdaptiveKernel> sweep;
+        std::vector<unsigned int> triangles;
+    };
+
+    ThreadPool pool;
+    std::vector<Scratch> scratch;
+};
+
+
+#endif //DELAUNAY_BATCH_H
@@ -0,0 +1,69 @@
+//
+// Created by lc06 on 4/28/2023.
+//
+
+#ifndef DELAUNAY_CIRCLEKERNEL_H
+#define DELAUNAY_CIRCLEKERNEL_H
+
+#include <cstdint>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/*
+ * Batched circumcircle filter over a block of SoA coordinates (a kd-tree leaf).
+ *
+ * Bit i of the result is set when (xs[i] - x0, ys[i] - y0) lies within squared distance r2 of (ox, oy).
+ * The circle is computed once by the caller, relative to (x0, y0) so that large coordinate offsets do
+ * not swamp its rounding, and r2 has to cover that rounding. The block is then tested 8 (AVX-512) or
+ * 4 (AVX2) points per instruction with the same operations as the scalar loop, which takes the
+ * remainder and non-AVX builds. This is only a filter, the exact incircle predicate still decides every
+ * reported point.
+ * count must not exceed 32.
+ */
+inline uint32_t circleMask(const double* xs, const double* ys, uint32_t count, double x0, double y0, double ox, double oy, double r2) {
+    uint32_t mask = 0, i = 0;
+
+#if defined(__AVX512F__)
+    __m512d vx0 = _mm512_set1_pd(x0), vy0 = _mm512_set1_pd(y0);
+    __m512d vox = _mm512_set1_pd(ox), voy = _mm512_set1_pd(oy), vr2 = _mm512_set1_pd(r2);
+    for(; i + 8 <= count; i += 8) {
+        __m512d dx = _mm512_sub_pd(_mm512_sub_pd(_mm512_loadu_pd(xs + i), vx0), vox);
+        __m512d dy = _mm512_sub_pd(_mm512_sub_pd(_mm512_loadu_pd(ys + i), vy0), voy);
+        __m512d d = _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+        mask |= (uint32_t)_mm512_cmp_pd_mask(d, vr2, _CMP_LE_OQ) << i;
+    }
+#elif defined(__AVX2__)
+    __m256d vx0 = _mm256_set1_pd(x0), vy0 = _mm256_set1_pd(y0);
+    __m256d vox = _mm256_set1_pd(ox), voy = _mm256_set1_pd(oy), vr2 = _mm256_set1_pd(r2);
+    for(; i + 4 <= count; i += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_sub_pd(_mm256_loadu_pd(xs + i), vx0), vox);
+        __m256d dy = _mm256_sub_pd(_mm256_sub_pd(_mm256_loadu_pd(ys + i), vy0), voy);
+        __m256d d = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+        mask |= (uint32_t)_mm256_movemask_pd(_mm256_cmp_pd(d, vr2, _CMP_LE_OQ)) << i;
+    }
+#endif
+
+    for(; i < count; ++i) {
+        double dx = (xs[i] - x0) - ox, dy = (ys[i] - y0) - oy;
+        if(dx * dx + dy * dy <= r2) mask |= 1u << i;
+    }
+    return mask;
+}
+
+// index of the lowest set bit of a non-zero mask
+inline uint32_t lowestBit(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+#endif //DELAUNAY_CIRCLEKERNEL_H
@@ -0,0 +1,445 @@
+//
+// Created by lc06 on 5/6/2023.
+//
+
+#include "Constrained.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+
+// v lies on the line through a and b on the side of b
+bool Constrained::ahead(uint32_t a, uint32_t b, uint32_t v) const {
+    const double *pa = point(a), *pb = point(b), *pv = point(v);
+    return orient(a, b, v) == 0. && (pv[0] - pa[0]) * (pb[0] - pa[0]) + (pv[1] - pa[1]) * (pb[1] - pa[1]) > 0.;
+}
+
+// half-edge from a to b, INVALID if there is none
+uint32_t Constrained::edge(uint32_t a, uint32_t b) const {
+    uint32_t start = tri.vertexEdge[a], e = start;
+    do {
+        if(tri.triangles[Triangulation::next(e)] == b) return e;
+        e = tri.halfedges[Triangulation::prev(e)];
+    } while(e != start);
+    return Triangulation::INVALID;
+}
+
+// edges crossed by the segment from a towards b, up to c: b itself or the first vertex on the way
+bool Constrained::cross(uint32_t a, uint32_t b, uint32_t& c) {
+    const auto& triangles = tri.triangles;
+    crossing.clear();
+    c = b;
+    if(edge(a, b) != Triangulation::INVALID) return true;
+
+    // the triangle of the star of a that the segment leaves through
+    uint32_t start = tri.vertexEdge[a], e = start, h = Triangulation::INVALID;
+    do {
+        uint32_t u = triangles[Triangulation::next(e)], w = triangles[Triangulation::prev(e)];
+        if(u != Triangulation::INFINITE && w != Triangulation::INFINITE) {
+            if(ahead(a, b, u) || ahead(a, b, w)) {
+                c = ahead(a, b, u) ? u : w;
+                return true;
+            }
+            if(orient(a, b, u) < 0. && orient(a, b, w) > 0.) {
+                h = Triangulation::next(e);
+                break;
+            }
+        }
+        e = tri.halfedges[Triangulation::prev(e)];
+    } while(e != start);
+    if(h == Triangulation::INVALID) return false;
+
+    // h runs from the vertex right of the segment to the one left of it
+    while(true) {
+        uint32_t u = triangles[h], w = triangles[Triangulation::next(h)];
+        if(isConstrained(u, w)) return false;
+        crossing.emplace_back(u, w);
+
+        uint32_t g = tri.halfedges[h], d = triangles[Triangulation::prev(g)];
+        if(d == Triangulation::INFINITE) return false;
+        if(d == b) return true;
+
+        double o = orient(a, b, d);
+        if(o == 0.) {
+            c = d;
+            return true;
+        }
+        h = o > 0. ? Triangulation::next(g) : Triangulation::prev(g);
+    }
+}
+
+// flip the crossing edges out until a - c is an edge
+void Constrained::resolve(uint32_t a, uint32_t c) {
+    const auto& triangles = tri.triangles;
+    std::deque<std::pair<uint32_t, uint32_t>> queue(crossing.begin(), crossing.end());
+    created.clear();
+
+    while(!queue.empty()) {
+        auto [u, w] = queue.front();
+        queue.pop_front();
+
+        uint32_t e = edge(u, w), f = tri.halfedges[e];
+        uint32_t p = triangles[Triangulation::prev(e)], q = triangles[Triangulation::prev(f)];
+
+        // only the diagonal of a convex quadrilateral can be flipped
+        double ou = orient(p, q, u), ow = orient(p, q, w);
+        if(!((ou > 0. && ow < 0.) || (ou < 0. && ow > 0.))) {
+            queue.emplace_back(u, w);
+            continue;
+        }
+        tri.flip(e);
+
+        double op = orient(a, c, p), oq = orient(a, c, q);
+        bool crosses = p != a && p != c && q != a && q != c && ((op > 0. && oq < 0.) || (op < 0. && oq > 0.));
+        if(crosses) queue.emplace_back(p, q);
+        else created.emplace_back(p, q);
+    }
+}
+
+// Lawson flips of the new edges, constrained edges stay
+void Constrained::restore() {
+    const auto& triangles = tri.triangles;
+    while(!created.empty()) {
+        auto [u, w] = created.back();
+        created.pop_back();
+        if(isConstrained(u, w)) continue;
+
+        uint32_t e = edge(u, w);
+        if(e == Triangulation::INVALID) continue;
+        uint32_t f = tri.halfedges[e];
+        if(tri.isGhost(e / 3) || tri.isGhost(f / 3)) continue;
+
+        uint32_t p = triangles[Triangulation::prev(e)], q = triangles[Triangulation::prev(f)];
+        if(incircle(point(u), point(w), point(p), point(q)) <= 0.) continue;
+
+        tri.flip(e);
+        created.emplace_back(u, q);
+        created.emplace_back(q, w);
+        created.emplace_back(w, p);
+        created.emplace_back(p, u);
+    }
+}
+
+bool Constrained::insert(uint32_t a, uint32_t b, bool ring) {
+    if(tri.vertexEdge[a] == Triangulation::INVALID || tri.vertexEdge[b] == Triangulation::INVALID) return false;
+
+    while(a != b) {
+        uint32_t c;
+        if(!cross(a, b, c)) return false;
+        resolve(a, c);
+
+        constrained.insert(key(a, c));
+        if(ring && !rings.erase(key(a, c))) rings.insert(key(a, c));
+        restore();
+        a = c;
+    }
+    return true;
+}
+
+std::vector<char> Constrained::regions(bool clip) const {
+    const auto& triangles = tri.triangles;
+    size_t n = triangles.size() / 3;
+
+    // parity of the rings around every triangle, spread from the hull edges
+    std::vector<char> inside(n, 1);
+    if(clip && !rings.empty()) {
+        std::vector<char> seen(n, 0);
+        std::vector<uint32_t> stack;
+        for(uint32_t t = 0; t < n; ++t) {
+            if(!tri.isAlive(t) || !tri.isGhost(t)) continue;
+            for(uint32_t e = 3 * t; e < 3 * t + 3; ++e) {
+                uint32_t u = triangles[e], w = triangles[Triangulation::next(e)];
+                if(u == Triangulation::INFINITE || w == Triangulation::INFINITE) continue;
+
+                uint32_t s = tri.halfedges[e] / 3;
+                if(seen[s]) continue;
+                seen[s] = 1;
+                inside[s] = rings.count(key(u, w)) != 0;
+                stack.push_back(s);
+            }
+        }
+
+        while(!stack.empty()) {
+            uint32_t t = stack.back();
+            stack.pop_back();
+            for(uint32_t e = 3 * t; e < 3 * t + 3; ++e) {
+                uint32_t s = tri.halfedges[e] / 3;
+                if(seen[s] || tri.isGhost(s)) continue;
+                seen[s] = 1;
+                inside[s] = inside[t] ^ (rings.count(key(triangles[e], triangles[Triangulation::next(e)])) != 0);
+                stack.push_back(s);
+            }
+        }
+    }
+
+    for(uint32_t t = 0; t < n; ++t)
+        if(!tri.isAlive(t) || tri.isGhost(t)) inside[t] = 0;
+    return inside;
+}
+
+std::vector<uint32_t> Constrained::collect(bool clip) const {
+    const auto& triangles = tri.triangles;
+    std::vector<char> inside = regions(clip);
+    std::vector<uint32_t> result;
+    for(uint32_t t = 0; t < inside.size(); ++t)
+        if(inside[t]) result.insert(result.end(), triangles.begin() + 3 * t, triangles.begin() + 3 * t + 3);
+    return result;
+}
+
+// constrained or hull edge
+bool Constrained::isSegment(uint32_t e) const {
+    const auto& triangles = tri.triangles;
+    return tri.isGhost(e / 3) || tri.isGhost(tri.halfedges[e] / 3) || isConstrained(triangles[e], triangles[Triangulation::next(e)]);
+}
+
+// (x, y) inside the diametral circle of the edge of e
+bool Constrained::encroaches(uint32_t e, double x, double y) const {
+    const double *a = point(tri.triangles[e]), *b = point(tri.triangles[Triangulation::next(e)]);
+    return (a[0] - x) * (b[0] - x) + (a[1] - y) * (b[1] - y) < 0.;
+}
+
+// a segment is encroached on by the vertex opposite to it in a triangle of the domain
+bool Constrained::isEncroached(uint32_t e) const {
+    for(uint32_t h : {e, tri.halfedges[e]}) {
+        if(!domain[h / 3]) continue;
+        const double* p = point(tri.triangles[Triangulation::prev(h)]);
+        if(encroaches(h, p[0], p[1])) return true;
+    }
+    return false;
+}
+
+// queue t if it is bad, and its segments if they are encroached on
+void Constrained::check(uint32_t t) {
+    const auto& triangles = tri.triangles;
+    uint32_t a = triangles[3 * t], b = triangles[3 * t + 1], c = triangles[3 * t + 2];
+    const double *pa = point(a), *pb = point(b), *pc = point(c);
+
+    for(uint32_t e = 3 * t; e < 3 * t + 3; ++e)
+        if(isSegment(e) && isEncroached(e)) encroached.emplace_back(triangles[e], triangles[Triangulation::next(e)]);
+
+    // R / shortest = product of the two longer edges / (4 * area)
+    double ab = std::hypot(pb[0] - pa[0], pb[1] - pa[1]), bc = std::hypot(pc[0] - pb[0], pc[1] - pb[1]);
+    double ca = std::hypot(pa[0] - pc[0], pa[1] - pc[1]);
+    double doubled = (pb[0] - pa[0]) * (pc[1] - pa[1]) - (pb[1] - pa[1]) * (pc[0] - pa[0]);
+    if(doubled <= 0.) return;
+
+    // a small angle between two segments cannot be refined away
+    double priority = ab * bc * ca / std::min({ab, bc, ca}) / (2. * doubled) / ratio;
+    uint32_t e = ab <= bc && ab <= ca ? 3 * t : bc <= ca ? 3 * t + 1 : 3 * t + 2;
+    if(isSegment(Triangulation::next(e)) && isSegment(Triangulation::prev(e))) priority = 0.;
+    if(area > 0.) priority = std::max(priority, doubled / (2. * area));
+    if(priority > 1. + 1e-9) bad.push({priority, t, a, b, c});
+}
+
+// circumcenter of t, or the off-center on the bisector of its shortest edge where that is closer
+void Constrained::center(uint32_t t, double& x, double& y) const {
+    const auto& triangles = tri.triangles;
+    uint32_t e = 3 * t;
+    double length = 0.;
+    for(uint32_t h = 3 * t; h < 3 * t + 3; ++h) {
+        const double *p = point(triangles[h]), *q = point(triangles[Triangulation::next(h)]);
+        double l = std::hypot(q[0] - p[0], q[1] - p[1]);
+        if(h == 3 * t || l < length) e = h, length = l;
+    }
+
+    const double *p = point(triangles[e]), *q = point(triangles[Triangulation::next(e)]), *r = point(triangles[Triangulation::prev(e)]);
+    double bx = q[0] - p[0], by = q[1] - p[1], cx = r[0] - p[0], cy = r[1] - p[1];
+    double d = 2. * (bx * cy - by * cx), b2 = bx * bx + by * by, c2 = cx * cx + cy * cy;
+    x = p[0] + (cy * b2 - by * c2) / d;
+    y = p[1] + (bx * c2 - cx * b2) / d;
+
+    double mx = (p[0] + q[0]) / 2., my = (p[1] + q[1]) / 2.;
+    double reach = std::hypot(x - mx, y - my), off = offset * length;
+    if(reach > off) {
+        x = mx + (x - mx) * off / reach;
+        y = my + (y - my) * off / reach;
+    }
+}
+
+// triangle containing (x, y), walking from t without crossing a segment; INVALID and the segment in the
+// way otherwise
+uint32_t Constrained::walk(uint32_t t, double x, double y, uint32_t& blocking) {
+    const auto& triangles = tri.triangles;
+    const double p[2] = {x, y};
+    while(true) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+
+        uint32_t next = Triangulation::INVALID;
+        for(uint32_t i = 0; i < 3 && next == Triangulation::INVALID; ++i) {
+            uint32_t e = 3 * t + (seed + i) % 3;
+            if(orient2d(point(triangles[e]), point(triangles[Triangulation::next(e)]), p) >= 0.) continue;
+            if(isSegment(e)) {
+                blocking = e;
+                return Triangulation::INVALID;
+            }
+            next = tri.halfedges[e] / 3;
+        }
+        if(next == Triangulation::INVALID) return t;
+        t = next;
+    }
+}
+
+// insert (x, y), which lies in t, unless it would encroach on a segment: then those are split; false
+// if nothing was inserted or split
+bool Constrained::split(uint32_t t, double x, double y, std::vector<double>& heights) {
+    const auto& triangles = tri.triangles;
+    const double p[2] = {x, y};
+
+    // the segments around the cavity the point would open
+    std::vector<uint32_t> cavity {t};
+    std::vector<std::pair<uint32_t, uint32_t>> hit;
+    for(size_t k = 0; k < cavity.size(); ++k)
+        for(uint32_t e = 3 * cavity[k]; e < 3 * cavity[k] + 3; ++e) {
+            if(isSegment(e)) {
+                if(encroaches(e, x, y)) hit.emplace_back(triangles[e], triangles[Triangulation::next(e)]);
+                continue;
+            }
+            uint32_t s = tri.halfedges[e] / 3;
+            if(std::find(cavity.begin(), cavity.end(), s) != cavity.end()) continue;
+            if(incircle(point(triangles[3 * s]), point(triangles[3 * s + 1]), point(triangles[3 * s + 2]), p) > 0.)
+                cavity.push_back(s);
+        }
+    if(!hit.empty()) {
+        bool any = false;
+        for(auto [u, w] : hit) {
+            uint32_t e = edge(u, w);
+            if(e != Triangulation::INVALID && splitSegment(e, heights)) any = true;
+        }
+        return any;
+    }
+
+    // inside t or on one of its edges
+    uint32_t on = Triangulation::INVALID;
+    double weight[3];
+    for(uint32_t i = 0; i < 3; ++i) {
+        uint32_t e = 3 * t + i;
+        const double *a = point(triangles[e]), *b = point(triangles[Triangulation::next(e)]);
+        if((a[0] == x && a[1] == y) || (b[0] == x && b[1] == y)) return false;
+        if(orient2d(a, b, p) == 0.) on = e;
+        weight[(i + 2) % 3] = (b[0] - a[0]) * (y - a[1]) - (b[1] - a[1]) * (x - a[0]);
+    }
+    double sum = weight[0] + weight[1] + weight[2];
+    heights.push_back((weight[0] * heights[triangles[3 * t]] + weight[1] * heights[triangles[3 * t + 1]]
+                       + weight[2] * heights[triangles[3 * t + 2]]) / sum);
+
+    place(tri.addVertex(x, y), t, on);
+    return true;
+}
+
+// split the segment of e at its midpoint, or on a concentric shell around its input vertex if the other
+// end is a Steiner point, so that segments meeting at a small angle get split at equal distances and stop
+// encroaching on each other; false if it is too short to split
+bool Constrained::splitSegment(uint32_t e, std::vector<double>& heights) {
+    uint32_t a = tri.triangles[e], b = tri.triangles[Triangulation::next(e)];
+    if((a >= first) != (b >= first) && a >= first) std::swap(a, b);
+    const double *pa = point(a), *pb = point(b);
+    double length = std::hypot(pb[0] - pa[0], pb[1] - pa[1]), s = 0.5;
+    if(length < shortest) return false;
+    if(a < first && b >= first) s = std::exp2(std::round(std::log2(length / 2.))) / length;
+
+    double x = pa[0] + s * (pb[0] - pa[0]), y = pa[1] + s * (pb[1] - pa[1]);
+    if((x == pa[0] && y == pa[1]) || (x == pb[0] && y == pb[1])) return false;
+    heights.push_back((1. - s) * heights[a] + s * heights[b]);
+
+    uint32_t v = tri.addVertex(x, y);
+    if(constrained.erase(key(a, b))) {
+        constrained.insert(key(a, v));
+        constrained.insert(key(v, b));
+    }
+    if(rings.erase(key(a, b))) {
+        rings.insert(key(a, v));
+        rings.insert(key(v, b));
+    }
+    place(v, e / 3, e);
+    return true;
+}
+
+// v goes into triangle t, or onto the edge of e, then the triangles around it are legalized and checked
+void Constrained::place(uint32_t v, uint32_t t, uint32_t e) {
+    const auto& triangles = tri.triangles;
+    created.clear();
+
+    if(e == Triangulation::INVALID) {
+        uint32_t a = triangles[3 * t], b = triangles[3 * t + 1], c = triangles[3 * t + 2];
+        char inside = domain[t];
+        tri.split(t, v);
+        domain.resize(triangles.size() / 3, 0);
+        for(uint32_t s : tri.lastAdded()) domain[s] = inside;
+        created = {{a, b}, {b, c}, {c, a}};
+    }
+    else {
+        if(tri.isGhost(e / 3)) e = tri.halfedges[e];
+        uint32_t f = tri.halfedges[e];
+        uint32_t a = triangles[e], b = triangles[Triangulation::next(e)], c = triangles[Triangulation::prev(e)], d = triangles[Triangulation::prev(f)];
+        char left = domain[e / 3], right = domain[f / 3];
+        tri.splitEdge(e, v);
+        domain.resize(triangles.size() / 3, 0);
+        for(uint32_t s : tri.lastAdded())
+            domain[s] = triangles[3 * s] == c || triangles[3 * s + 1] == c || triangles[3 * s + 2] == c ? left : right;
+        created = {{a, c}, {c, b}};
+        if(d != Triangulation::INFINITE) {
+            created.emplace_back(b, d);
+            created.emplace_back(d, a);
+        }
+    }
+    restore();
+
+    for(uint32_t s : tri.lastAdded())
+        if(domain[s]) check(s);
+}
+
+size_t Constrained::refine(double minAngle, double maxArea, size_t limit, std::vector<double>& heights) {
+    const auto& triangles = tri.triangles;
+    const double radians = minAngle * 3.14159265358979323846 / 180.;
+    ratio = minAngle > 0. ? 1. / (2. * std::sin(radians)) : std::numeric_limits<double>::infinity();
+    offset = minAngle > 0. ? 1. / (2. * std::tan(radians / 2.)) : std::numeric_limits<double>::infinity();
+    area = maxArea;
+
+    domain = regions(true);
+    bad = {};
+    encroached.clear();
+    for(uint32_t t = 0; t < domain.size(); ++t)
+        if(domain[t]) check(t);
+
+    // the input vertices, and the shortest segment worth splitting
+    first = tri.coords.size() / 2;
+    double x0 = tri.coords[0], x1 = x0, y0 = tri.coords[1], y1 = y0;
+    for(uint32_t v = 0; v < first; ++v) {
+        x0 = std::min(x0, tri.coords[2 * v]), x1 = std::max(x1, tri.coords[2 * v]);
+        y0 = std::min(y0, tri.coords[2 * v + 1]), y1 = std::max(y1, tri.coords[2 * v + 1]);
+    }
+    shortest = 1e-9 * std::max(x1 - x0, y1 - y0);
+
+    while(tri.coords.size() / 2 - first < limit) {
+        // encroached segments first
+        if(!encroached.empty()) {
+            auto [u, w] = encroached.back();
+            encroached.pop_back();
+            uint32_t e = edge(u, w);
+            if(e != Triangulation::INVALID && isSegment(e) && isEncroached(e)) splitSegment(e, heights);
+            continue;
+        }
+        if(bad.empty()) break;
+
+        Bad worst = bad.top();
+        bad.pop();
+        uint32_t t = worst.t;
+        if(!tri.isAlive(t) || triangles[3 * t] != worst.a || triangles[3 * t + 1] != worst.b || triangles[3 * t + 2] != worst.c) continue;
+
+        double x, y;
+        center(t, x, y);
+        uint32_t blocking, s = walk(t, x, y, blocking);
+        if(s == Triangulation::INVALID ? !splitSegment(blocking, heights) : !split(s, x, y, heights)) continue;
+
+        // t is back in the queue if it survived a segment split
+        if(tri.isAlive(t) && triangles[3 * t] == worst.a && triangles[3 * t + 1] == worst.b && triangles[3 * t + 2] == worst.c) bad.push(worst);
+    }
+
+    domain.clear();
+    bad = {};
+    encroached.clear();
+    return tri.coords.size() / 2 - first;
+}
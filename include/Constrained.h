@@ -0,0 +1,98 @@
+//
+// Created by lc06 on 5/6/2023.
+//
+
+#ifndef DELAUNAY_CONSTRAINED_H
+#define DELAUNAY_CONSTRAINED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <queue>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "Triangulation.h"
+
+/*
+ * Constrained Delaunay triangulation on top of a complete Triangulation.
+ *
+ * A segment is recovered by walking from one end and collecting the edges it crosses, which are then
+ * flipped away (Sloan's method): a crossing edge whose quadrilateral is convex is flipped, a new diagonal
+ * that still crosses goes back into the queue, the others are legalized afterwards with flips that never
+ * cross a constrained edge. Vertices exactly on a segment split it. Constrained edges are kept by vertex
+ * pair, so they survive the flips that renumber half-edges.
+ *
+ * Ring edges bound regions: collect(true) keeps the finite triangles inside an odd number of rings, so
+ * an outer boundary with holes keeps exactly its polygon.
+ *
+ * refine is Ruppert's Delaunay refinement of that domain. Triangles whose circumradius to shortest edge
+ * ratio or area is too large wait in a priority queue, worst first, and get a Steiner point: their
+ * circumcenter, or Ungor's off-center where that is closer to the shortest edge. The point is walked to
+ * from the triangle without crossing a segment, i.e. a constrained or hull edge; a segment in the way,
+ * or one whose diametral circle contains the point, is split instead. Segments that a vertex encroaches
+ * on are split before any triangle.
+ */
+class Constrained {
+public:
+    explicit Constrained(Triangulation& _tri) : tri(_tri) {}
+
+    // make a - b a chain of edges of the triangulation, false if it crosses an earlier constraint;
+    // the part before the crossing is kept
+    bool insert(uint32_t a, uint32_t b, bool ring);
+    bool isConstrained(uint32_t a, uint32_t b) const { return constrained.count(key(a, b)) != 0; }
+
+    // finite triangles, all of them or only those inside the rings
+    std::vector<uint32_t> collect(bool clip) const;
+
+    // insert Steiner points until no triangle inside the rings has an angle below minAngle degrees
+    // (up to ~30 reliably) or an area above maxArea (0: no bound), at most limit of them. heights holds
+    // a value per vertex and is extended with interpolated ones. Returns the number of points inserted
+    size_t refine(double minAngle, double maxArea, size_t limit, std::vector<double>& heights);
+
+private:
+    Triangulation& tri;
+    std::unordered_set<uint64_t> constrained;
+    std::unordered_set<uint64_t> rings;     // edges on an odd number of rings
+
+    std::vector<std::pair<uint32_t, uint32_t>> crossing;
+    std::vector<std::pair<uint32_t, uint32_t>> created;
+
+    struct Bad {
+        double priority;
+        uint32_t t, a, b, c;
+        bool operator<(const Bad& other) const { return priority < other.priority; }
+    };
+    std::vector<char> domain;           // triangle slot -> inside the rings, while refining
+    std::priority_queue<Bad> bad;
+    std::vector<std::pair<uint32_t, uint32_t>> encroached;
+    double ratio {0};                   // largest circumradius / shortest edge allowed
+    double offset {0};                  // off-center distance / shortest edge
+    double area {0};
+    double shortest {0};                // segments below this length are not split
+    uint32_t first {0};                 // vertices from here on are Steiner points
+    uint32_t seed {2463534242u};
+
+    static uint64_t key(uint32_t a, uint32_t b) { return a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a; }
+    const double* point(uint32_t v) const { return &tri.coords[2 * v]; }
+    double orient(uint32_t a, uint32_t b, uint32_t c) const { return orient2d(point(a), point(b), point(c)); }
+    bool ahead(uint32_t a, uint32_t b, uint32_t v) const;
+    uint32_t edge(uint32_t a, uint32_t b) const;
+    bool cross(uint32_t a, uint32_t b, uint32_t& c);
+    void resolve(uint32_t a, uint32_t c);
+    void restore();
+
+    std::vector<char> regions(bool clip) const;
+    bool isSegment(uint32_t e) const;
+    bool encroaches(uint32_t e, double x, double y) const;
+    bool isEncroached(uint32_t e) const;
+    void check(uint32_t t);
+    void center(uint32_t t, double& x, double& y) const;
+    uint32_t walk(uint32_t t, double x, double y, uint32_t& blocking);
+    bool split(uint32_t t, double x, double y, std::vector<double>& heights);
+    bool splitSegment(uint32_t e, std::vector<double>& heights);
+    void place(uint32_t v, uint32_t t, uint32_t e);
+};
+
+
+#endif //DELAUNAY_CONSTRAINED_H
@@ -4,8 +4,24 @@
 
 
 #include "Delaunay.h"
+#include "Triangulation.h"
+#include "DivideConquer.h"
+#include "SpatialSort.h"
+#include "SweepHull.h"
+#include "KdTree.h"
+#include "EdgeTable.h"
+#include "ThreadPool.h"
+#include "Lawson.h"
+#include "Constrained.h"
+#include "Tetrahedralization.h"
+#include "Predicates.h"
 
-void Delaunay::readFile(std::string path) {
+#include <array>
+#include <cctype>
+#include <charconv>
+
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::readFile(std::string path) {
     std::fstream fin;
     fin.open(path, std::ios::in);
 
@@ -15,18 +31,20 @@ void Delaunay::readFile(std::string path) {
     }
 
     std::string line;
-    int i = 1;
+    Index i = 1;
     while(std::getline(fin, line, '\n')) {
+        // the 1-based ids have to fit the index type
+        if(points.size() >= std::numeric_limits<Index>::max()) {
+            std::cout << "more points than the index type can address, the rest is ignored" << std::endl;
+            break;
+        }
 
         std::stringstream word(line);
-        float p[4];
+        Coord p[4];
         word >> p[0] >> p[1] >> p[2] >> p[3];
-        p[0] = i++;
 
         p_z.emplace_back(p[3]);
-        p[3] = 1.0f;
-
-        points.emplace_back(p);
+        points.emplace_back(i++, p[1], p[2], Coord(1));
     }
     fin.close();
 
@@ -37,9 +55,81 @@ void Delaunay::readFile(std::string path) {
     bound.z_min = std::min_element(points.begin(), points.end(), [](auto& p1, auto& p2) {return p1.z < p2.z;})->z;
     bound.z_max = std::max_element(points.begin(), points.end(), [](auto& p1, auto& p2) {return p1.z < p2.z;})->z;
 
+    std::vector<double> coords;
+    coords.reserve(2 * points.size());
+    for(auto& p : points) {
+        coords.push_back(p.x);
+        coords.push_back(p.y);
+    }
+    if(lattice.detect(coords))
+        std::cout << "regular grid of " << lattice.nx << " x " << lattice.ny << " nodes, spacing " << lattice.dx << " / " << lattice.dy << std::endl;
+}
+
+template<typename Coord, typename Index>
+bool Delaunay<Coord, Index>::updateHeights(std::string path, std::vector<Index>& triIDs) {
+    std::fstream fin;
+    fin.open(path, std::ios::in);
+
+    if(fin.fail()) {
+        std::cout << "read file failed!" << std::endl;
+        return false;
+    }
+
+    // same layout as readFile, parsed straight from one buffer since the file is all there is to the update;
+    // the epoch only counts as a height update if every x / y matches
+    fin.seekg(0, std::ios::end);
+    std::string text(fin.tellg(), '\0');
+    fin.seekg(0, std::ios::beg);
+    fin.read(&text[0], text.size());
+    fin.close();
+
+    const char* c = text.data();
+    const char* end = c + text.size();
+    auto number = [&](bool& ok) {
+        while(c < end && std::isspace((unsigned char)*c)) c++;
+        Coord v {};
+        auto result = std::from_chars(c, end, v);
+        ok = ok && result.ec == std::errc();
+        c = result.ptr;
+        return v;
+    };
+
+    std::vector<Coord> z;
+    z.reserve(points.size());
+    bool same = true;
+    while(same) {
+        bool ok = true;
+        Coord p[4];
+        for(auto& v : p) v = number(ok);
+        if(!ok) break;
+
+        size_t i = z.size();
+        same = i < points.size() && points[i].x == p[1] && points[i].y == p[2];
+        z.emplace_back(p[3]);
+    }
+
+    if(same && z.size() == points.size()) {
+        p_z.swap(z);
+        computeNormals();
+        return true;
+    }
+
+    // the points moved: start over from the file
+    std::cout << "x / y differ from the loaded points, triangulating again" << std::endl;
+    points.clear();
+    p_z.clear();
+    removed.clear();
+    hidden.clear();
+    hierarchy = Hierarchy();
+    readFile(std::move(path));
+
+    triIDs.clear();
+    generateTIN(triIDs);
+    return false;
 }
 
-int Delaunay::getIndex(int i, int j, int size) {
+template<typename Coord, typename Index>
+int Delaunay<Coord, Index>::getIndex(int i, int j, int size) {
 
     if(i > j)
         std::swap(i, j);
@@ -56,7 +146,8 @@ int Delaunay::getIndex(int i, int j, int size) {
     return (2 * size - 1 - i) * i / 2 + (j - i);
 }
 
-void Delaunay::getIJ(int index, int& i, int& j, int size) {
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::getIJ(int index, int& i, int& j, int size) {
     // (0, 1) => ((7 - 1) + (7 - 0)) * 0 / 2 + (1 - 0) = 1
     // (5, 6) => ((7 - 1) + (7 - 5)) * 5 / 2 + (6 - 5) = 21
     index += 1;
@@ -68,102 +159,1071 @@ void Delaunay::getIJ(int index, int& i, int& j, int size) {
     }
 }
 
-void Delaunay::generateTIN(std::vector<unsigned int>& triIDs) {
-    std::stack<Edge> edges;
-    std::vector<double> dists;
-    std::vector<std::pair<int, int>> indices;
+// triangles closing the pockets between the boundary of mesh and the convex hull of its vertices, by a
+// Graham scan along the counterclockwise boundary from its lowest vertex, which is on the hull
+static std::vector<unsigned int> hullPockets(const std::vector<double>& coords, const HalfEdgeMesh& mesh, Arithmetic arithmetic) {
+    const uint32_t INVALID = Triangulation::INVALID;
+    std::vector<uint32_t> after(coords.size() / 2, INVALID);
+    uint32_t start = INVALID;
+    for(uint32_t e = 0; e < mesh.triangles.size(); ++e) {
+        if(mesh.halfedges[e] != INVALID) continue;
+        uint32_t v = mesh.triangles[e];
+        after[v] = mesh.triangles[HalfEdgeMesh::next(e)];
+        if(start == INVALID || coords[2 * v] < coords[2 * start] || (coords[2 * v] == coords[2 * start] && coords[2 * v + 1] < coords[2 * start + 1]))
+            start = v;
+    }
+
+    std::vector<unsigned int> pockets;
+    if(start == INVALID) return pockets;
+
+    std::vector<uint32_t> chain {start};
+    uint32_t v = start;
+    do {
+        v = after[v];
+        while(chain.size() >= 2 && orient2d(&coords[2 * chain[chain.size() - 2]], &coords[2 * chain.back()], &coords[2 * v], arithmetic) < 0.) {
+            pockets.insert(pockets.end(), {chain[chain.size() - 2], v, chain.back()});
+            chain.pop_back();
+        }
+        chain.push_back(v);
+    } while(v != start);
+    return pockets;
+}
+
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::generateTIN(std::vector<Index>& triIDs) {
+    compact();
+    dynamic = false;
+
+    // constraints and refinement need the incremental triangulation; otherwise a grid is split cell by
+    // cell and the algorithms only run when its holes are too large for that
+    bool constrained = !breaklines.empty() || !boundaries.empty() || minAngle > 0. || maxArea > 0.;
+    bool grid = !constrained && !lattice.empty() && lattice.triangulate(mesh);
+    if(!constrained && !lattice.empty() && !grid) std::cout << "grid holes too large, triangulating the points in general" << std::endl;
+    if(grid && !lattice.exact) {
+        // nodes off their column or row, and ears chosen on the integer grid, may leave illegal edges and
+        // a boundary that is not convex in the real coordinates; Lawson keeps the boundary, so it is closed first
+        std::vector<double> coords = planarCoords();
+        std::vector<unsigned int> triangles = mesh.triangles, pockets = hullPockets(coords, mesh, arithmetic);
+        triangles.insert(triangles.end(), pockets.begin(), pockets.end());
+        ThreadPool pool(threadCount);
+        Lawson(coords, arithmetic).legalize(std::move(triangles), mesh, pool);
+    }
 
-    std::unordered_map<long, bool> existed {};
+    threads = threadCount;
+    Algorithm run = algorithm == Algorithm::Auto && !grid && !constrained ? plan() : algorithm;
 
-    int pointsSize = points.size();
+    if(constrained) constrainedTIN();
+    else if(!grid) switch(run) {
+        case Algorithm::BowyerWatson:
+            bowyerWatson();
+            break;
+        case Algorithm::DivideConquer:
+            divideConquer();
+            break;
+        case Algorithm::SweepHull:
+            sweepHull();
+            break;
+        default:
+            advancingFront();
+    }
 
-    for(int i=0; i < pointsSize; ++i) {
-        for(int j=i+1; j < pointsSize; j++) {
-            Edge e(points[i], points[j]);
-            double dist = e.length();
-            dists.push_back(dist);
-            indices.emplace_back(i, j);
+    triIDs.reserve(triIDs.size() + mesh.triangles.size());
+    for(auto v : mesh.triangles) triIDs.push_back(Index(v));
+    computeNormals();
+}
+
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::generateTetrahedra(std::vector<Index>& tetIDs) {
+    compact();
+
+    std::vector<double> coords(3 * points.size());
+    for(size_t k = 0; k < points.size(); ++k) {
+        coords[3 * k] = points[k].x;
+        coords[3 * k + 1] = points[k].y;
+        coords[3 * k + 2] = p_z[k];
+    }
+
+    Tetrahedralization volume(std::move(coords));
+    uint32_t inserted = volume.triangulate();
+    if(inserted == 0 && !points.empty()) std::cout << "the points are coplanar, there are no tetrahedra" << std::endl;
+    else if(inserted < points.size()) std::cout << points.size() - inserted << " repeated points left out" << std::endl;
+
+    std::vector<uint32_t> tets = volume.getTetrahedra();
+    tetIDs.reserve(tetIDs.size() + tets.size());
+    for(auto v : tets) tetIDs.push_back(Index(v));
+}
+
+/*
+ * Relative cost per n log n of the engines in this tree, one thread, measured over uniform, sorted,
+ * clustered, ring shaped and 75% repeated inputs of 100k points: the sweep was fastest on all of them, so
+ * the sample decides how many points are really there and whether a parallel run can overtake it.
+ * Every thread beyond the first adds PARALLEL_GAIN, and a thread needs a core and PARALLEL_SHARE distinct
+ * points.
+ */
+template<typename Coord, typename Index>
+Algorithm Delaunay<Coord, Index>::plan() {
+    constexpr double SWEEP_COST = 1.0, BOWYER_WATSON_COST = 2.2, DIVIDE_CONQUER_COST = 2.7, ADVANCING_FRONT_COST = 13.;
+    constexpr double PARALLEL_GAIN = 0.6;
+    constexpr size_t PARALLEL_SHARE = 50000, SAMPLE = 4096;
+
+    size_t n = points.size(), stride = std::max<size_t>(1, n / SAMPLE);
+    std::vector<std::pair<Coord, Coord>> sample;
+    sample.reserve(n / stride + 1);
+    for(size_t k = 0; k < n; k += stride) sample.emplace_back(points[k].x, points[k].y);
+
+    // clustered: the share of empty cells when the sample is binned four to a cell over the bounding box
+    size_t g = std::max<size_t>(1, (size_t)std::sqrt(sample.size() / 4.));
+    std::vector<char> occupied(g * g, 0);
+    double w = std::max((double)bound.x_max - bound.x_min, 1e-300), h = std::max((double)bound.y_max - bound.y_min, 1e-300);
+    for(auto& p : sample) {
+        size_t i = std::min(g - 1, (size_t)((p.first - bound.x_min) / w * g));
+        size_t j = std::min(g - 1, (size_t)((p.second - bound.y_min) / h * g));
+        occupied[j * g + i] = 1;
+    }
+    double clustered = 1. - (double)std::count(occupied.begin(), occupied.end(), 1) / occupied.size();
+
+    std::sort(sample.begin(), sample.end());
+    double duplicates = sample.empty() ? 0. : 1. - (double)(std::unique(sample.begin(), sample.end()) - sample.begin()) / sample.size();
+
+    double distinct = std::max(3., n * (1. - duplicates)), work = distinct * std::log2(distinct);
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int t = std::max(1u, std::min({threadCount, cores, (unsigned int)(distinct / PARALLEL_SHARE)}));
+    double speedup = 1. + PARALLEL_GAIN * (t - 1);
+
+    // the fronts of a parallel advancing front start from equal cells of the box, which clustered points
+    // leave partly idle
+    struct Estimate {
+        Algorithm algorithm;
+        const char* name;
+        double cost;
+        unsigned int threads;
+    } estimates[4] = {
+        {Algorithm::SweepHull, "sweep hull", SWEEP_COST * work, 1},
+        {Algorithm::BowyerWatson, "Bowyer-Watson", BOWYER_WATSON_COST * work, 1},
+        {Algorithm::DivideConquer, "divide and conquer", DIVIDE_CONQUER_COST * work / speedup, t},
+        {Algorithm::AdvancingFront, "advancing front", ADVANCING_FRONT_COST * work / (1. + (speedup - 1.) * (1. - clustered)), t}
+    };
+    auto best = std::min_element(estimates, estimates + 4, [](const Estimate& a, const Estimate& b) { return a.cost < b.cost; });
+    threads = best->threads;
+
+    std::cout << "auto: " << n << " points, " << std::round(100. * duplicates) << "% repeated, "
+              << std::round(100. * clustered) << "% empty cells" << std::endl;
+    for(auto& e : estimates) {
+        std::cout << "  " << e.name << " on " << e.threads << (e.threads == 1 ? " thread: " : " threads: ") << e.cost / best->cost;
+        if(&e == best) std::cout << "  <-";
+        std::cout << std::endl;
+    }
+    return best->algorithm;
+}
+
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::legalize(std::vector<Index>& triIDs) {
+    if(triIDs.size() % 3 != 0 || std::any_of(triIDs.begin(), triIDs.end(), [&](Index v) { return v >= points.size(); })) {
+        std::cout << "legalize: not a triangulation of the loaded points" << std::endl;
+        return;
+    }
+
+    std::vector<double> coords = planarCoords();
+    ThreadPool pool(threadCount);
+    size_t flips = Lawson(coords, arithmetic).legalize(std::vector<unsigned int>(triIDs.begin(), triIDs.end()), mesh, pool);
+    std::cout << "legalize: " << flips << " flips" << std::endl;
+
+    triIDs.assign(mesh.triangles.begin(), mesh.triangles.end());
+    computeNormals();
+    dynamic = false;
+}
+
+// close the outer side of every convex hull edge, collinear hull points included;
+// returns for every point the lowest id at its position, repeated positions are left out
+static std::vector<uint32_t> closeHull(const std::vector<double>& coords, EdgeTable& table, Arithmetic arithmetic) {
+    std::vector<uint32_t> sorted(coords.size() / 2);
+    for(uint32_t i = 0; i < sorted.size(); ++i) sorted[i] = i;
+    std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) {
+        return coords[2 * a] < coords[2 * b] || (coords[2 * a] == coords[2 * b] && (coords[2 * a + 1] < coords[2 * b + 1] ||
+               (coords[2 * a + 1] == coords[2 * b + 1] && a < b)));
+    });
+
+    std::vector<uint32_t> canonical(sorted.size());
+    for(size_t k = 0; k < sorted.size(); ++k) {
+        uint32_t v = sorted[k], u = k > 0 ? canonical[sorted[k - 1]] : v;
+        canonical[v] = k > 0 && coords[2 * v] == coords[2 * u] && coords[2 * v + 1] == coords[2 * u + 1] ? u : v;
+    }
+    sorted.erase(std::remove_if(sorted.begin(), sorted.end(), [&](uint32_t v) { return canonical[v] != v; }), sorted.end());
+
+    std::vector<uint32_t> chain;
+    for(int pass = 0; pass < 2; ++pass) {
+        chain.clear();
+        for(auto v : sorted) {
+            while(chain.size() >= 2 && orient2d(&coords[2 * chain[chain.size() - 2]], &coords[2 * chain.back()], &coords[2 * v], arithmetic) < 0.)
+                chain.pop_back();
+            chain.push_back(v);
         }
+
+        // the interior is left of chain[k - 1] -> chain[k]
+        for(size_t k = 1; k < chain.size(); ++k)
+            table.set(chain[k - 1], chain[k], chain[k - 1] < chain[k] ? 1 : 0, EdgeTable::OUTSIDE);
+
+        std::reverse(sorted.begin(), sorted.end());
     }
+    return canonical;
+}
+
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::advancingFront() {
+    std::vector<double> coords = planarCoords();
+    KdTree tree(coords, arithmetic);
 
-    int index_ij = std::min_element(dists.begin(), dists.end()) - dists.begin();
-    auto [i, j] = indices[index_ij];
+    // side of edge ab (as stored in the table) on which c lies
+    auto side = [&](uint32_t a, uint32_t b, uint32_t c) {
+        if(a > b) std::swap(a, b);
+        return orient2d(&coords[2 * a], &coords[2 * b], &coords[2 * c], arithmetic) > 0. ? 0 : 1;
+    };
+
+    // sized for every edge, so the fronts can share it without the table ever growing
+    EdgeTable table(3 * points.size());
+    std::vector<uint32_t> canonical = closeHull(coords, table, arithmetic);
+
+    mesh.clear();
+
+    uint32_t i, j;
+    if(!tree.closestPair(i, j)) return;
+
+    // open edges searched together on the pool before their triangles are committed in order
+    constexpr size_t EDGE_BATCH = 64;
+    // below this many points a single front is faster than starting threads
+    constexpr size_t PARALLEL_POINTS = 4096;
+
+    struct Front {
+        std::vector<std::pair<uint32_t, uint32_t>> edges;       // stack of edges with an open side
+        std::vector<std::pair<uint32_t, uint32_t>> deferred;    // left for the serial pass
+        std::vector<unsigned int> triangles;
+        std::vector<uint32_t> candidates;
+    };
+
+    // whether triangle (i1, i2, c) fits the sides already taken: a side taken by another triangle means it
+    // would overlap that one, unless it is this very triangle committed by another front
+    auto fits = [&](uint32_t i1, uint32_t i2, uint32_t c) {
+        uint32_t t1 = table.get(i1, c).apex[side(i1, c, i2)], t2 = table.get(i2, c).apex[side(i2, c, i1)];
+        return (t1 == EdgeTable::INVALID || t1 == i2) && (t2 == EdgeTable::INVALID || t2 == i1);
+    };
+
+    // apex of each open side of edge (i1, i2), i1 < i2: the nearest candidate with an empty (perturbed)
+    // circumcircle, INVALID for a side without one. Under the perturbation that apex is unique, it is
+    // the one the max-min-angle rule of the original loop looks for, and fronts meeting from different
+    // seeds find the same one. Only reads the tree and the table.
+    auto search = [&](uint32_t i1, uint32_t i2, std::vector<uint32_t>& candidates, uint32_t* best) {
+        const double* p1 = &coords[2 * i1];
+        const double* p2 = &coords[2 * i2];
+
+        EdgeTable::Sides sides = table.get(i1, i2);
+        best[0] = best[1] = EdgeTable::INVALID;
+        bool resolved[2] = {sides.apex[0] != EdgeTable::INVALID, sides.apex[1] != EdgeTable::INVALID};
+
+        double mx = (p1[0] + p2[0]) / 2., my = (p1[1] + p2[1]) / 2.;
+        for(size_t k = 16, done = 0; done < tree.size() && !(resolved[0] && resolved[1]); k *= 2) {
+            tree.nearest(mx, my, k, candidates);
+
+            for(size_t n = done; n < candidates.size() && !(resolved[0] && resolved[1]); ++n) {
+                uint32_t v = candidates[n];
+                if(v == i1 || v == i2 || canonical[v] != v) continue;
+
+                double o = orient2d(p1, p2, &coords[2 * v], arithmetic);
+                if(o == 0.) continue;
+                int s = o > 0. ? 0 : 1;
+                if(resolved[s] || tree.anyInCircle(i1, i2, v) || !fits(i1, i2, v)) continue;
+
+                resolved[s] = true;
+                best[s] = v;
+            }
+            done = candidates.size();
+        }
+    };
+
+    // settle the open sides of edge (i1, i2) with the apexes search found. A concurrent front defers a
+    // side without any candidate to the serial pass.
+    auto commit = [&](uint32_t i1, uint32_t i2, const uint32_t* best, Front& front, bool concurrent) {
+        EdgeTable::Sides sides = table.get(i1, i2);
+        if(!sides.isOpen()) return;
 
-    edges.emplace(points[i], points[j]);
+        bool deferred = false;
+        for(int s = 0; s < 2; ++s) {
+            if(sides.apex[s] != EdgeTable::INVALID) continue;
+            if(best[s] == EdgeTable::INVALID) {
+                if(concurrent) deferred = true;
+                else table.claim(i1, i2, s, EdgeTable::OUTSIDE);
+                continue;
+            }
+
+            // another front may be building the same triangle from one of its other edges: both claim
+            // all three sides and only the one winning the side of the lowest edge emits it
+            uint32_t c = best[s];
+            bool won[3] = {table.claim(i1, i2, s, c), table.claim(i1, c, side(i1, c, i2), i2), table.claim(i2, c, side(i2, c, i1), i1)};
+            std::pair<uint32_t, uint32_t> keys[3] = {{i1, i2}, {std::min(i1, c), std::max(i1, c)}, {std::min(i2, c), std::max(i2, c)}};
+            if(!won[std::min_element(keys, keys + 3) - keys]) continue;
+
+            // counterclockwise, so that twins run in opposite directions
+            front.triangles.push_back(s == 0 ? i1 : i2);
+            front.triangles.push_back(s == 0 ? i2 : i1);
+            front.triangles.push_back(c);
+
+            if(table.get(i1, c).isOpen()) front.edges.emplace_back(std::min(i1, c), std::max(i1, c));
+            if(table.get(i2, c).isOpen()) front.edges.emplace_back(std::min(i2, c), std::max(i2, c));
+        }
+
+        if(deferred) front.deferred.emplace_back(i1, i2);
+    };
 
-    int count = 0;
-    while(!edges.empty()) {
-        auto edge = edges.top();
-        edges.pop();
+    Front front;
+    i = canonical[i], j = canonical[j];
+    front.edges.emplace_back(std::min(i, j), std::max(i, j));
 
-        auto p1 = edge.p1;
-        auto p2 = edge.p2;
+    if(threads > 1 && points.size() >= PARALLEL_POINTS) {
+        // one seed per cell of a grid over the points: the edge from the point nearest to the cell
+        // centre to its nearest neighbour, which is always Delaunay; cells are dealt to the threads in turn
+        double x0 = bound.x_min, y0 = bound.y_min, x1 = bound.x_max, y1 = bound.y_max;
+        if(arithmetic == Arithmetic::Snapped) x0 = y0 = 0., x1 = snap(bound.x_max, bound.x_min), y1 = snap(bound.y_max, bound.y_min);
 
-        double maxMinAngle = 0.0;
-        Point _p;
+        unsigned int cells = 1;
+        while(cells * cells < 4 * threads) cells++;
 
-        int a, b, c;
-        long index;
-        for(auto&p : points) {
-            if(p == p1 || p == p2) continue;
-            a = p1.id, b = p2.id, c = p.id;
+        std::vector<Front> fronts(threads);
+        std::vector<uint32_t> nearest;
+        for(unsigned int c = 0; c < cells * cells; ++c) {
+            double cx = x0 + (c % cells + 0.5) * (x1 - x0) / cells, cy = y0 + (c / cells + 0.5) * (y1 - y0) / cells;
 
-            if(a > c) std::swap(a, c);
-            if(b > c) std::swap(b, c);
-            if(a > b) std::swap(a, b);
+            tree.nearest(cx, cy, 1, nearest);
+            uint32_t v = canonical[nearest[0]];
+            for(size_t k = 2; k <= 2 * tree.size(); k *= 2) {
+                tree.nearest(coords[2 * v], coords[2 * v + 1], k, nearest);
+                auto u = std::find_if(nearest.begin(), nearest.end(), [&](uint32_t w) { return canonical[w] == w && w != v; });
+                if(u == nearest.end()) continue;
 
-            index = a * 100000000 + b * 10000 + c;
-            if(existed[index]) continue;
+                fronts[c % threads].edges.emplace_back(std::min(v, *u), std::max(v, *u));
+                break;
+            }
+        }
 
-            Triangle tri(edge, Edge(p2, p), Edge(p, p1));
-            if(!tri.isReseaonable()) continue;
+        std::vector<std::thread> workers;
+        for(unsigned int k = 0; k < threads; ++k) {
+            workers.emplace_back([&, k]() {
+                Front& own = fronts[k];
+                uint32_t best[2];
+                while(!own.edges.empty()) {
+                    auto [i1, i2] = own.edges.back();
+                    own.edges.pop_back();
+                    if(!table.get(i1, i2).isOpen()) continue;
 
-            bool flag = false;
-            for(auto& p_: points)
-                if(p_ != p1 && p_ != p2 && p_ != p && tri.inside(p_)) {
-                    flag = true;
-                    break;
+                    search(i1, i2, own.candidates, best);
+                    commit(i1, i2, best, own, true);
                 }
-            if(flag) continue;
+            });
+        }
+        for(auto& worker : workers) worker.join();
+
+        // the serial pass picks up where the fronts stopped
+        front.edges.clear();
+        for(auto& own : fronts) {
+            front.triangles.insert(front.triangles.end(), own.triangles.begin(), own.triangles.end());
+            front.edges.insert(front.edges.end(), own.deferred.begin(), own.deferred.end());
+        }
+    }
 
-            if(tri.minAngle() > maxMinAngle){
-                maxMinAngle = tri.minAngle();
-                _p = p;
+    // the open edges on top of the stack are searched in parallel against the table as it is, then
+    // committed in stack order. An apex that no longer fits the sides taken in the meantime is searched
+    // again; the table only gains sides, so any other result is still what a serial search would find,
+    // and the triangulation does not depend on the thread count
+    ThreadPool pool(threads);
+    std::vector<std::pair<uint32_t, uint32_t>> batch;
+    std::vector<std::vector<uint32_t>> candidates(EDGE_BATCH);
+    std::vector<uint32_t> best(2 * EDGE_BATCH);
+    while(!front.edges.empty()) {
+        batch.clear();
+        while(!front.edges.empty() && batch.size() < EDGE_BATCH) {
+            if(table.get(front.edges.back().first, front.edges.back().second).isOpen()) batch.push_back(front.edges.back());
+            front.edges.pop_back();
+        }
+
+        pool.parallelFor(batch.size(), [&](size_t n) { search(batch[n].first, batch[n].second, candidates[n], &best[2 * n]); });
+
+        for(size_t n = 0; n < batch.size(); ++n) {
+            auto [i1, i2] = batch[n];
+            uint32_t* apex = &best[2 * n];
+            if((apex[0] != EdgeTable::INVALID && !fits(i1, i2, apex[0])) || (apex[1] != EdgeTable::INVALID && !fits(i1, i2, apex[1])))
+                search(i1, i2, front.candidates, apex);
+            commit(i1, i2, apex, front, false);
+        }
+    }
+
+    mesh.build(std::move(front.triangles));
+}
+
+template<typename Coord, typename Index>
+std::vector<double> Delaunay<Coord, Index>::planarCoords() {
+    std::vector<double> coords;
+    coords.reserve(2 * points.size());
+
+    arithmetic = Arithmetic::Adaptive;
+    if(snapResolution > 0) {
+        // grid coordinates relative to the lower left corner, exact integers in doubles
+        double extent = std::max((double)bound.x_max - bound.x_min, (double)bound.y_max - bound.y_min);
+        if(std::round(extent / snapResolution) < SNAP_LIMIT) {
+            snapOrigin[0] = bound.x_min, snapOrigin[1] = bound.y_min;
+            for(auto& p : points) {
+                coords.push_back(snap(p.x, bound.x_min));
+                coords.push_back(snap(p.y, bound.y_min));
             }
+            arithmetic = Arithmetic::Snapped;
+            return coords;
         }
+        std::cout << "extent too large for the snap resolution, using adaptive predicates" << std::endl;
+    }
 
-        a = p1.id, b = p2.id, c = _p.id;
+    for(auto& p : points) {
+        coords.push_back(p.x);
+        coords.push_back(p.y);
+    }
+    return coords;
+}
 
-        if(c == 0) continue;
+template<typename Coord, typename Index>
+double Delaunay<Coord, Index>::snap(Coord v, Coord origin) const {
+    double s = std::round(((double)v - origin) / snapResolution);
+    // queries may lie outside the grid, clamping keeps their differences within the integer predicates
+    return std::min(std::max(s, -(SNAP_LIMIT - 1.)), SNAP_LIMIT - 1.);
+}
 
-        if(a > c) std::swap(a, c);
-        if(b > c) std::swap(b, c);
-        if(a > b) std::swap(a, b);
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::buildHierarchy() {
+    std::vector<double> coords = planarCoords();
 
-        index = a * 100000000 + b * 10000 + c;
-        if(existed[index]) continue;
+    // BRIO permutation: insertion position -> file id
+    permutation = brioOrder(coords);
+    inverse.resize(permutation.size());
+    for(uint32_t v = 0; v < permutation.size(); ++v) inverse[permutation[v]] = v;
 
-        existed[index] = true;
+    // store the vertices in insertion order, so consecutive insertions touch neighbouring memory
+    std::vector<double> sorted(coords.size());
+    for(size_t i = 0; i < permutation.size(); ++i) {
+        sorted[2 * i] = coords[2 * permutation[i]];
+        sorted[2 * i + 1] = coords[2 * permutation[i] + 1];
+    }
 
-        triIDs.push_back(a - 1);
-        triIDs.push_back(b - 1);
-        triIDs.push_back(c - 1);
+    hierarchy = Hierarchy(std::move(sorted));
+    hidden.clear();
+    for(uint32_t v = 0; v < permutation.size(); ++v) {
+        if(isRemoved(permutation[v])) continue;
+        if(!hierarchy.insert(v)) hidden.emplace(holder(v), permutation[v]);
+        for(auto u : hierarchy.lastRepeats()) hidden.emplace(holder(u), permutation[u]);
+    }
+    dynamic = false;
+}
 
-        Triangle tri(Point(points[a-1].x, points[a-1].y, p_z[a-1]),
-                     Point(points[b-1].x, points[b-1].y, p_z[b-1]),
-                     Point(points[c-1].x, points[c-1].y, p_z[c-1]));
-        points[a-1].normal += tri.getNormal();
-        points[a-1].normal += tri.getNormal();
-        points[a-1].normal += tri.getNormal();
+// base vertex at the position of hierarchy vertex v, which may itself be left out as a repeat
+template<typename Coord, typename Index>
+uint32_t Delaunay<Coord, Index>::holder(uint32_t v) {
+    Triangulation& base = hierarchy.base();
+    double x = base.coords[2 * v], y = base.coords[2 * v + 1];
 
-        edges.emplace(p1, _p);
-        edges.emplace(p2, _p);
+    uint32_t t = hierarchy.locate(x, y);
+    return t == Triangulation::INVALID ? Triangulation::INVALID : base.nearestVertex(t, x, y);
+}
 
-        std::cout << count++ << ", " << a << ", " << b << ", " << c << std::endl;
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::bowyerWatson() {
+    buildHierarchy();
+    meshFromHierarchy();
+}
+
+// every segment as the chain of points x, y, ... it is cut into by the segments crossing its interior;
+// the candidates of a segment are those starting left of its right end, in order of the left ends
+static std::vector<std::vector<double>> splitCrossings(const std::vector<std::array<double, 4>>& segments) {
+    std::vector<std::vector<std::pair<double, std::pair<double, double>>>> cuts(segments.size());
+    std::vector<uint32_t> order(segments.size());
+    for(uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+    auto left = [&](uint32_t i) { return std::min(segments[i][0], segments[i][2]); };
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return left(a) < left(b); });
+
+    for(size_t k = 0; k < order.size(); ++k) {
+        const auto& s = segments[order[k]];
+        double right = std::max(s[0], s[2]);
+        for(size_t l = k + 1; l < order.size() && left(order[l]) <= right; ++l) {
+            const auto& r = segments[order[l]];
+            if(std::max(s[1], s[3]) < std::min(r[1], r[3]) || std::max(r[1], r[3]) < std::min(s[1], s[3])) continue;
+
+            double o1 = orient2d(&s[0], &s[2], &r[0]), o2 = orient2d(&s[0], &s[2], &r[2]);
+            double o3 = orient2d(&r[0], &r[2], &s[0]), o4 = orient2d(&r[0], &r[2], &s[2]);
+            if(!((o1 > 0. && o2 < 0.) || (o1 < 0. && o2 > 0.)) || !((o3 > 0. && o4 < 0.) || (o3 < 0. && o4 > 0.))) continue;
+
+            // proper crossing: o1 / o2 are the signed distances of r's ends from s, o3 / o4 those of s's ends
+            double ts = o3 / (o3 - o4), tr = o1 / (o1 - o2);
+            std::pair<double, double> x {s[0] + ts * (s[2] - s[0]), s[1] + ts * (s[3] - s[1])};
+            cuts[order[k]].emplace_back(ts, x);
+            cuts[order[l]].emplace_back(tr, x);
+        }
+    }
+
+    std::vector<std::vector<double>> chains(segments.size());
+    for(size_t i = 0; i < segments.size(); ++i) {
+        std::sort(cuts[i].begin(), cuts[i].end());
+        chains[i] = {segments[i][0], segments[i][1]};
+        for(auto& [t, x] : cuts[i]) {
+            chains[i].push_back(x.first);
+            chains[i].push_back(x.second);
+        }
+        chains[i].push_back(segments[i][2]);
+        chains[i].push_back(segments[i][3]);
     }
+    return chains;
 }
 
-void Delaunay::getVertices(std::vector<float>& vertices) {
+// Delaunay triangulation of the points and the constraint vertices, then the constraints are forced in
+// on a copy of the base level, so the hierarchy stays Delaunay for insert / remove
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::constrainedTIN() {
+    buildHierarchy();
+    mesh.clear();
+    if(hierarchy.empty()) return;
+
+    std::vector<std::array<double, 4>> segments;
+    std::vector<char> ring;
+    auto add = [&](const std::vector<Coord>& xy, bool closed) {
+        size_t m = xy.size() / 2;
+        for(size_t i = 0; i + 1 < m; ++i) {
+            segments.push_back({xy[2 * i], xy[2 * i + 1], xy[2 * i + 2], xy[2 * i + 3]});
+            ring.push_back(closed);
+        }
+        if(closed && m > 2 && (xy[0] != xy[2 * m - 2] || xy[1] != xy[2 * m - 1])) {
+            segments.push_back({xy[2 * m - 2], xy[2 * m - 1], xy[0], xy[1]});
+            ring.push_back(closed);
+        }
+    };
+    for(auto& xy : breaklines) add(xy, false);
+    for(auto& xy : boundaries) add(xy, true);
+
+    // every constraint vertex, crossings included, goes in before the first edge is forced
+    std::vector<std::vector<double>> chains = splitCrossings(segments);
+    std::vector<std::vector<uint32_t>> vertices(chains.size());
+    for(size_t k = 0; k < chains.size(); ++k)
+        for(size_t i = 0; i + 1 < chains[k].size(); i += 2) vertices[k].push_back(constraintVertex(Coord(chains[k][i]), Coord(chains[k][i + 1])));
+
+    Triangulation base = hierarchy.base();
+    Constrained cdt(base);
+    size_t failed = 0;
+    for(size_t k = 0; k < vertices.size(); ++k)
+        for(size_t i = 0; i + 1 < vertices[k].size(); ++i) {
+            uint32_t a = vertices[k][i], b = vertices[k][i + 1];
+            if(a == Triangulation::INVALID || b == Triangulation::INVALID || a == b) continue;
+            if(!cdt.insert(a, b, ring[k])) failed++;
+        }
+    if(failed > 0) std::cout << failed << " constraint segments could not be recovered and were left out" << std::endl;
+
+    if(minAngle > 0. || maxArea > 0.) refine(base, cdt);
+
+    std::vector<unsigned int> triangles;
+    for(auto v : cdt.collect(true)) triangles.push_back(permutation[v]);
+    mesh.build(std::move(triangles));
+}
+
+// Delaunay refinement of the constrained triangulation, its Steiner points become points of the hierarchy too
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::refine(Triangulation& base, Constrained& cdt) {
+    if(arithmetic == Arithmetic::Snapped) {
+        std::cout << "refinement needs the adaptive predicates, turn the snap resolution off" << std::endl;
+        return;
+    }
+
+    size_t n = base.coords.size() / 2;
+    std::vector<double> heights(n);
+    for(size_t v = 0; v < n; ++v) heights[v] = p_z[permutation[v]];
+
+    // enough for the size bound over the whole extent, and a cap against constraints at sharp angles
+    double extent = double(bound.x_max - bound.x_min) * double(bound.y_max - bound.y_min);
+    size_t limit = 16 * n + 1024 + (maxArea > 0. ? size_t(std::min(4. * extent / maxArea, 1e9)) : 0);
+    limit = std::min(limit, size_t(std::numeric_limits<Index>::max()) - points.size());
+
+    size_t steiner = cdt.refine(minAngle, maxArea, limit, heights);
+    if(steiner == limit) std::cout << "refinement stopped after " << limit << " Steiner points" << std::endl;
+
+    for(size_t v = n; v < n + steiner; ++v) {
+        Coord x = Coord(base.coords[2 * v]), y = Coord(base.coords[2 * v + 1]);
+        Index id = points.size();
+        points.emplace_back(Index(id + 1), x, y, Coord(1));
+        p_z.push_back(Coord(heights[v]));
+        bound.x_min = std::min(bound.x_min, x), bound.x_max = std::max(bound.x_max, x);
+        bound.y_min = std::min(bound.y_min, y), bound.y_max = std::max(bound.y_max, y);
+
+        uint32_t u = hierarchy.addVertex(base.coords[2 * v], base.coords[2 * v + 1]);
+        permutation.push_back(id);
+        inverse.resize(points.size());
+        inverse[id] = u;
+        if(!hierarchy.insert(u)) hidden.emplace(holder(u), id);
+    }
+    lattice.clear();
+
+    std::cout << "refinement: " << steiner << " Steiner points" << std::endl;
+}
+
+// base vertex at (x, y), a new point with its height interpolated from the triangulation if there is none
+template<typename Coord, typename Index>
+uint32_t Delaunay<Coord, Index>::constraintVertex(Coord x, Coord y) {
+    Triangulation& base = hierarchy.base();
+    double px = x, py = y;
+    if(arithmetic == Arithmetic::Snapped) px = snap(x, snapOrigin[0]), py = snap(y, snapOrigin[1]);
+
+    uint32_t t = hierarchy.locate(px, py);
+    if(t == Triangulation::INVALID) return Triangulation::INVALID;
+    uint32_t nearest = base.nearestVertex(t, px, py);
+    if(base.coords[2 * nearest] == px && base.coords[2 * nearest + 1] == py) return nearest;
+    if(points.size() >= std::numeric_limits<Index>::max()) return Triangulation::INVALID;
+
+    Coord z = p_z[permutation[nearest]];
+    if(!base.isGhost(t)) {
+        const double* a = &base.coords[2 * base.triangles[3 * t]];
+        const double* b = &base.coords[2 * base.triangles[3 * t + 1]];
+        const double* c = &base.coords[2 * base.triangles[3 * t + 2]];
+        double area = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+        double la = ((b[0] - px) * (c[1] - py) - (b[1] - py) * (c[0] - px)) / area;
+        double lb = ((c[0] - px) * (a[1] - py) - (c[1] - py) * (a[0] - px)) / area;
+        z = Coord(la * p_z[permutation[base.triangles[3 * t]]] + lb * p_z[permutation[base.triangles[3 * t + 1]]]
+                  + (1. - la - lb) * p_z[permutation[base.triangles[3 * t + 2]]]);
+    }
+
+    Index id = points.size();
+    points.emplace_back(Index(id + 1), x, y, Coord(1));
+    p_z.push_back(z);
+    bound.x_min = std::min(bound.x_min, x), bound.x_max = std::max(bound.x_max, x);
+    bound.y_min = std::min(bound.y_min, y), bound.y_max = std::max(bound.y_max, y);
+    lattice.clear();
+
+    uint32_t v = hierarchy.addVertex(px, py);
+    permutation.push_back(id);
+    inverse.resize(points.size());
+    inverse[id] = v;
+    if(hierarchy.insert(v)) return v;
+
+    // snapped onto an existing vertex
+    hidden.emplace(holder(v), id);
+    return holder(v);
+}
+
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::meshFromHierarchy() {
+    Triangulation& base = hierarchy.base();
+    base.getMesh(mesh);
+    for(auto& v : mesh.triangles) v = permutation[v];
+
+    // getMesh numbers the finite triangles in slot order
+    slotTriangle.assign(base.triangles.size() / 3, Triangulation::INVALID);
+    triangleSlot.clear();
+    for(uint32_t t = 0; t < slotTriangle.size(); ++t) {
+        if(!base.isAlive(t) || base.isGhost(t)) continue;
+        slotTriangle[t] = triangleSlot.size();
+        triangleSlot.push_back(t);
+    }
+    dynamic = true;
+}
+
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::startDynamic(std::vector<Index>& triIDs) {
+    if(dynamic && triIDs.size() == mesh.triangles.size()) return;
+
+    if(!dynamic) {
+        if(hierarchy.empty()) buildHierarchy();
+        meshFromHierarchy();
+        computeNormals();
+    }
+    triIDs.assign(mesh.triangles.begin(), mesh.triangles.end());
+}
+
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::updateMesh(std::vector<Index>& triIDs) {
+    Triangulation& base = hierarchy.base();
+    std::vector<unsigned int> touched;
+    std::vector<uint32_t> relink;
+
+    // drop the triangles that went away, the last mesh triangle fills the gap
+    for(auto t : base.lastRemoved()) {
+        uint32_t m = t < slotTriangle.size() ? slotTriangle[t] : Triangulation::INVALID;
+        if(m == Triangulation::INVALID) continue;
+        slotTriangle[t] = Triangulation::INVALID;
+        touched.insert(touched.end(), mesh.triangles.begin() + 3 * m, mesh.triangles.begin() + 3 * m + 3);
+
+        uint32_t last = triangleSlot.size() - 1;
+        if(m != last) {
+            for(uint32_t i = 0; i < 3; ++i) {
+                mesh.triangles[3 * m + i] = mesh.triangles[3 * last + i];
+                triIDs[3 * m + i] = triIDs[3 * last + i];
+            }
+            triangleSlot[m] = triangleSlot[last];
+            slotTriangle[triangleSlot[m]] = m;
+            relink.push_back(triangleSlot[m]);
+        }
+        triangleSlot.pop_back();
+        mesh.triangles.resize(3 * last);
+        mesh.halfedges.resize(3 * last);
+        triIDs.resize(3 * last);
+    }
+
+    slotTriangle.resize(base.triangles.size() / 3, Triangulation::INVALID);
+    for(auto t : base.lastAdded()) {
+        relink.push_back(t);
+        if(!base.isAlive(t) || base.isGhost(t)) continue;
+
+        slotTriangle[t] = triangleSlot.size();
+        triangleSlot.push_back(t);
+        for(uint32_t i = 0; i < 3; ++i) {
+            unsigned int v = permutation[base.triangles[3 * t + i]];
+            mesh.triangles.push_back(v);
+            mesh.halfedges.push_back(HalfEdgeMesh::INVALID);
+            triIDs.push_back(Index(v));
+            touched.push_back(v);
+        }
+    }
+
+    // twins from the base level, both ways, so the old neighbours point at the new triangles
+    for(auto t : relink) {
+        if(!base.isAlive(t)) continue;
+        uint32_t m = slotTriangle[t];
+        for(uint32_t i = 0; i < 3; ++i) {
+            uint32_t o = base.halfedges[3 * t + i];
+            uint32_t n = slotTriangle[o / 3];
+            if(m != Triangulation::INVALID) mesh.halfedges[3 * m + i] = n == Triangulation::INVALID ? HalfEdgeMesh::INVALID : 3 * n + o % 3;
+            if(n != Triangulation::INVALID) mesh.halfedges[3 * n + o % 3] = m == Triangulation::INVALID ? HalfEdgeMesh::INVALID : 3 * m + i;
+        }
+    }
+
+    for(auto v : touched) computeNormal(v);
+}
+
+
+template<typename Coord, typename Index>
+Index Delaunay<Coord, Index>::insert(Coord x, Coord y, Coord z, std::vector<Index>& triIDs) {
+    if(points.size() >= std::numeric_limits<Index>::max()) {
+        std::cout << "more points than the index type can address, the point is ignored" << std::endl;
+        return std::numeric_limits<Index>::max();
+    }
+    startDynamic(triIDs);
+
+    Index id = points.size();
+    points.emplace_back(id + 1, x, y, Coord(1));
+    p_z.emplace_back(z);
+    if(!removed.empty()) removed.push_back(0);
+
+    attach(id, triIDs);
+    return id;
+}
+
+template<typename Coord, typename Index>
+bool Delaunay<Coord, Index>::remove(Index id, std::vector<Index>& triIDs) {
+    if(id >= points.size() || isRemoved(id)) return false;
+    startDynamic(triIDs);
+
+    if(!detach(id, triIDs)) {
+        std::cout << "remove: point " << id << " is needed to keep a triangle" << std::endl;
+        return false;
+    }
+
+    if(removed.empty()) removed.assign(points.size(), 0);
+    removed[id] = 1;
+    points[id].normal = {0.f, 0.f, 0.f};
+    return true;
+}
+
+template<typename Coord, typename Index>
+bool Delaunay<Coord, Index>::move(Index id, Coord x, Coord y, std::vector<Index>& triIDs) {
+    if(id >= points.size() || isRemoved(id)) return false;
+    startDynamic(triIDs);
+
+    Triangulation& base = hierarchy.base();
+    uint32_t v = inverse[id];
+    double px = x, py = y;
+    if(arithmetic == Arithmetic::Snapped) px = snap(x, snapOrigin[0]), py = snap(y, snapOrigin[1]);
+
+    // a vertex alone at its position that stays inside its star is repaired with flips,
+    // everything else is taken out and put back under the same id
+    if(base.vertexEdge[v] != Triangulation::INVALID && hidden.count(v) == 0 && hierarchy.move(v, px, py)) {
+        points[id].x = x, points[id].y = y;
+        lattice.clear();
+        updateMesh(triIDs);
+
+        // the star keeps its triangles but not their normals
+        computeNormal(id);
+        uint32_t start = base.vertexEdge[v], e = start;
+        do {
+            computeNormal(permutation[base.triangles[Triangulation::next(e)]]);
+            e = base.halfedges[Triangulation::prev(e)];
+        } while(e != start);
+    }
+    else {
+        if(!detach(id, triIDs)) {
+            std::cout << "move: point " << id << " is needed to keep a triangle" << std::endl;
+            return false;
+        }
+        points[id].x = x, points[id].y = y;
+        attach(id, triIDs);
+    }
+    return true;
+}
+
+// put point id into the triangulation at its current position, as a hidden repeat if the position is taken
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::attach(Index id, std::vector<Index>& triIDs) {
+    lattice.clear();
+    Coord x = points[id].x, y = points[id].y;
+    bound.x_min = std::min(bound.x_min, x), bound.x_max = std::max(bound.x_max, x);
+    bound.y_min = std::min(bound.y_min, y), bound.y_max = std::max(bound.y_max, y);
+
+    uint32_t v = arithmetic == Arithmetic::Snapped ? hierarchy.addVertex(snap(x, snapOrigin[0]), snap(y, snapOrigin[1]))
+                                                   : hierarchy.addVertex(x, y);
+    permutation.push_back(id);
+    if(inverse.size() <= id) inverse.resize(id + 1);
+    inverse[id] = v;
+
+    // until the first triangle exists the base level is rebuilt wholesale and has nothing to patch
+    bool empty = hierarchy.empty();
+    if(!hierarchy.insert(v)) hidden.emplace(holder(v), id);
+    else if(!empty) updateMesh(triIDs);
+    else {
+        for(auto u : hierarchy.lastRepeats()) hidden.emplace(holder(u), permutation[u]);
+        meshFromHierarchy();
+        triIDs.assign(mesh.triangles.begin(), mesh.triangles.end());
+        computeNormals();
+    }
+}
+
+// take point id out of the triangulation, false if that would leave no triangle
+template<typename Coord, typename Index>
+bool Delaunay<Coord, Index>::detach(Index id, std::vector<Index>& triIDs) {
+    lattice.clear();
+    Triangulation& base = hierarchy.base();
+    uint32_t v = inverse[id];
+    auto repeat = hidden.find(v);
+
+    if(base.vertexEdge[v] == Triangulation::INVALID) {
+        // a repeat, nothing to retriangulate
+        auto range = hidden.equal_range(holder(v));
+        for(auto it = range.first; it != range.second; ++it)
+            if(it->second == id) {
+                hidden.erase(it);
+                break;
+            }
+    }
+    else if(repeat != hidden.end()) {
+        // a point repeating the position takes the vertex over, only ids and heights change
+        Index h = repeat->second;
+        hidden.erase(repeat);
+        permutation[v] = h;
+        inverse[h] = v;
+
+        std::vector<unsigned int> touched {unsigned(h)};
+        uint32_t start = base.vertexEdge[v], e = start;
+        do {
+            uint32_t m = slotTriangle[e / 3];
+            if(m != Triangulation::INVALID) {
+                for(uint32_t i = 3 * m; i < 3 * m + 3; ++i) {
+                    if(mesh.triangles[i] == id) mesh.triangles[i] = h, triIDs[i] = h;
+                    else touched.push_back(mesh.triangles[i]);
+                }
+            }
+            e = base.halfedges[Triangulation::prev(e)];
+        } while(e != start);
+
+        for(auto u : touched) computeNormal(u);
+    }
+    else {
+        if(!hierarchy.remove(v)) return false;
+        updateMesh(triIDs);
+    }
+    return true;
+}
+
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::compact() {
+    if(removed.empty()) return;
+
+    size_t k = 0;
+    for(size_t i = 0; i < points.size(); ++i) {
+        if(removed[i]) continue;
+        points[k] = points[i];
+        points[k].id = Index(k + 1);
+        p_z[k++] = p_z[i];
+    }
+    points.resize(k);
+    p_z.resize(k);
+    removed.clear();
+
+    hierarchy = Hierarchy();
+    dynamic = false;
+}
+
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::divideConquer() {
+    std::vector<double> coords = planarCoords();
+
+    // the kernel is fixed here, once per run, so the predicates do not branch on the arithmetic
+    std::vector<unsigned int> triangles;
+    if(arithmetic == Arithmetic::Snapped) DivideConquer<SnappedKernel>(coords, threads).triangulate(triangles);
+    else DivideConquer<AdaptiveKernel>(coords, threads).triangulate(triangles);
+
+    mesh.build(std::move(triangles));
+}
+
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::sweepHull() {
+    std::vector<double> coords = planarCoords();
+
+    mesh.clear();
+    if(arithmetic == Arithmetic::Snapped) {
+        SweepHull<SnappedKernel> sweep;
+        sweep.triangulate(coords.data(), points.size(), mesh.triangles);
+        mesh.halfedges.swap(sweep.halfedges);
+    }
+    else {
+        SweepHull<AdaptiveKernel> sweep;
+        sweep.triangulate(coords.data(), points.size(), mesh.triangles);
+        mesh.halfedges.swap(sweep.halfedges);
+    }
+}
+
+template<typename Coord, typename Index>
+glm::vec3 Delaunay<Coord, Index>::faceNormal(unsigned int a, unsigned int b, unsigned int c) const {
+    glm::vec3 ab(points[b].x - points[a].x, points[b].y - points[a].y, p_z[b] - p_z[a]);
+    glm::vec3 bc(points[c].x - points[b].x, points[c].y - points[b].y, p_z[c] - p_z[b]);
+
+    // facing up, whatever the winding
+    glm::vec3 normal = glm::normalize(glm::cross(ab, bc));
+    if(normal.z < 0) normal = -normal;
+    return normal;
+}
+
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::computeNormals() {
+    size_t count = mesh.triangleCount();
+
+    // vertex -> incident triangles, in triangle order so every sum adds up in the same order as a serial pass
+    std::vector<uint32_t> offsets(points.size() + 1, 0), incident(mesh.triangles.size());
+    for(auto v : mesh.triangles) offsets[v + 1]++;
+    for(size_t v = 0; v < points.size(); ++v) offsets[v + 1] += offsets[v];
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for(size_t e = 0; e < mesh.triangles.size(); ++e) incident[cursor[mesh.triangles[e]]++] = e / 3;
+
+    constexpr size_t CHUNK = 4096;
+    ThreadPool pool(threadCount);
+    std::vector<glm::vec3> faces(count);
+    pool.parallelRanges(count, CHUNK, [&](size_t begin, size_t end) {
+        for(size_t t = begin; t < end; ++t)
+            faces[t] = faceNormal(mesh.triangles[3 * t], mesh.triangles[3 * t + 1], mesh.triangles[3 * t + 2]);
+    });
+    pool.parallelRanges(points.size(), CHUNK, [&](size_t begin, size_t end) {
+        for(size_t v = begin; v < end; ++v) {
+            glm::vec3 normal = {0.f, 0.f, 0.f};
+            for(uint32_t k = offsets[v]; k < offsets[v + 1]; ++k) normal += faces[incident[k]];
+            points[v].normal = normal;
+        }
+    });
+}
+
+// sum over the star of v on the base level, while insert / remove keep the mesh in step with it
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::computeNormal(unsigned int v) {
+    Triangulation& base = hierarchy.base();
+    points[v].normal = {0.f, 0.f, 0.f};
+
+    uint32_t start = base.vertexEdge[inverse[v]], e = start;
+    if(start == Triangulation::INVALID) return;
+    do {
+        uint32_t t = e / 3;
+        if(!base.isGhost(t))
+            points[v].normal += faceNormal(permutation[base.triangles[3 * t]], permutation[base.triangles[3 * t + 1]], permutation[base.triangles[3 * t + 2]]);
+        e = base.halfedges[Triangulation::prev(e)];
+    } while(e != start);
+}
+
+// triangle of mesh containing (x, y) by jump-and-walk from the closest corner of ~sqrt(n) sampled
+// triangles; INVALID when the walk leaves the mesh, whose outline need not be convex
+template<typename Coord, typename Index>
+uint32_t Delaunay<Coord, Index>::walkMesh(double x, double y) const {
+    uint32_t count = mesh.triangles.size() / 3;
+    if(count == 0) return Triangulation::INVALID;
+
+    auto planar = [this](uint32_t v, double* p) {
+        if(arithmetic == Arithmetic::Snapped) p[0] = snap(points[v].x, snapOrigin[0]), p[1] = snap(points[v].y, snapOrigin[1]);
+        else p[0] = points[v].x, p[1] = points[v].y;
+    };
+    uint32_t seed = 2463534242u;
+    auto random = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    };
+
+    uint32_t samples = 1;
+    while(samples * samples < count) samples++;
+
+    uint32_t t = 0;
+    double bestDist = std::numeric_limits<double>::infinity();
+    for(uint32_t k = 0; k < samples; ++k) {
+        uint32_t e = random() % (3 * count);
+        double q[2];
+        planar(mesh.triangles[e], q);
+        double dist = (q[0] - x) * (q[0] - x) + (q[1] - y) * (q[1] - y);
+        if(dist < bestDist) {
+            t = e / 3;
+            bestDist = dist;
+        }
+    }
+
+    // remembering stochastic walk, as in Triangulation::locate
+    const double p[2] = {x, y};
+    while(true) {
+        uint32_t start = random() % 3;
+        bool moved = false;
+        for(uint32_t k = 0; k < 3; ++k) {
+            uint32_t e = 3 * t + (start + k) % 3;
+            double a[2], b[2];
+            planar(mesh.triangles[e], a);
+            planar(mesh.triangles[HalfEdgeMesh::next(e)], b);
+            if(orient2d(a, b, p, arithmetic) < 0.) {
+                if(mesh.halfedges[e] == Triangulation::INVALID) return Triangulation::INVALID;
+                t = mesh.halfedges[e] / 3;
+                moved = true;
+                break;
+            }
+        }
+        if(!moved) return t;
+    }
+}
+
+template<typename Coord, typename Index>
+bool Delaunay<Coord, Index>::locate(Coord x, Coord y, Index& a, Index& b, Index& c) {
+    double px = x, py = y;
+    if(arithmetic == Arithmetic::Snapped) px = snap(x, snapOrigin[0]), py = snap(y, snapOrigin[1]);
+
+    if(hierarchy.empty()) {
+        uint32_t t = walkMesh(px, py);
+        if(t != Triangulation::INVALID) {
+            a = mesh.triangles[3 * t];
+            b = mesh.triangles[3 * t + 1];
+            c = mesh.triangles[3 * t + 2];
+            return true;
+        }
+        buildHierarchy();
+    }
+    if(hierarchy.empty()) return false;
+
+    uint32_t t = hierarchy.locate(px, py);
+    Triangulation& tri = hierarchy.base();
+    if(t == Triangulation::INVALID || tri.isGhost(t)) return false;
+
+    a = permutation[tri.triangles[3 * t]];
+    b = permutation[tri.triangles[3 * t + 1]];
+    c = permutation[tri.triangles[3 * t + 2]];
+    return true;
+}
+
+template<typename Coord, typename Index>
+void Delaunay<Coord, Index>::getVertices(std::vector<float>& vertices) {
 
     for(auto& p : points) {
         vertices.push_back(p.id);
@@ -179,4 +1239,11 @@ void Delaunay::getVertices(std::vector<float>& vertices) {
 
     }
 
-}
\ No newline at end of file
+}
+
+template class Delaunay<float, uint16_t>;
+template class Delaunay<float, uint32_t>;
+template class Delaunay<float, uint64_t>;
+template class Delaunay<double, uint16_t>;
+template class Delaunay<double, uint32_t>;
+template class Delaunay<double, uint64_t>;
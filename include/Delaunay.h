@@ -15,65 +15,77 @@
 #include <stack>
 #include <map>
 #include <algorithm>
+#include <thread>
+#include <limits>
+#include <type_traits>
 #include <glm/glm.hpp>
 
+#include "HalfEdgeMesh.h"
+#include "Hierarchy.h"
+#include "Predicates.h"
+#include "Lattice.h"
+
+class Constrained;
+
+template<typename T, typename I = uint32_t>
 struct Point {
-    float id{};
-    float x{};
-    float y{};
-    float z{};
+    I id{};
+    T x{};
+    T y{};
+    T z{};
 
     glm::vec3 normal = {0.f, 0.f, 0.f};
 
     Point() = default;
-    Point(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
-    Point(float _id, float _x, float _y, float _z) : id(_id), x(_x), y(_y), z(_z) {}
-    explicit Point(float* p) : id(p[0]), x(p[1]), y(p[2]), z(p[3]) {}
+    Point(T _x, T _y, T _z) : x(_x), y(_y), z(_z) {}
+    Point(I _id, T _x, T _y, T _z) : id(_id), x(_x), y(_y), z(_z) {}
 
-    Point& operator = (Point& p) = default;
+    Point& operator = (const Point& p) = default;
 
-    bool operator == (Point& p) const {
+    bool operator == (const Point& p) const {
         if(id == p.id) return true;
         else return false;
     }
 
-    bool operator != (Point& p) const {
+    bool operator != (const Point& p) const {
         return !(*this == p);
     }
 };
 
+template<typename T, typename I = uint32_t>
 struct Edge {
-    Point p1;
-    Point p2;
+    Point<T, I> p1;
+    Point<T, I> p2;
 
     Edge() = default;
-    Edge(Point _p1, Point _p2) : p1(_p1), p2(_p2) {}
+    Edge(Point<T, I> _p1, Point<T, I> _p2) : p1(_p1), p2(_p2) {}
 
-    double length() {
+    T length() const {
         return sqrt((p1.x - p2.x) * (p1.x - p2.x) + (p1.y - p2.y) * (p1.y - p2.y) + (p1.z - p2.z) * (p1.z - p2.z));
     }
 
     glm::vec3 getEdgeVector() const {
-        return {p2.x - p1.x, p2.y - p1.y, p2.z - p1.z};
+        return glm::vec3(p2.x - p1.x, p2.y - p1.y, p2.z - p1.z);
     }
 };
 
+template<typename T, typename I = uint32_t>
 struct Triangle {
-    Edge l1;
-    Edge l2;
-    Edge l3;
+    Edge<T, I> l1;
+    Edge<T, I> l2;
+    Edge<T, I> l3;
 
-    double a;
-    double b;
-    double c;
+    T a;
+    T b;
+    T c;
 
     Triangle() = default;
-    Triangle(Edge _l1, Edge _l2, Edge _l3) : l1(_l1), l2(_l2), l3(_l3) {
+    Triangle(Edge<T, I> _l1, Edge<T, I> _l2, Edge<T, I> _l3) : l1(_l1), l2(_l2), l3(_l3) {
         a = l1.length();
         b = l2.length();
         c = l3.length();
     }
-    Triangle(Point _p1, Point _p2, Point _p3) : l1(Edge(_p1, _p2)), l2(Edge(_p2, _p3)), l3(Edge(_p3, _p1)) {
+    Triangle(Point<T, I> _p1, Point<T, I> _p2, Point<T, I> _p3) : l1(_p1, _p2), l2(_p2, _p3), l3(_p3, _p1) {
         a = l1.length();
         b = l2.length();
         c = l3.length();
@@ -112,37 +124,15 @@ struct Triangle {
         return normal;
     }
 
-    bool inside(Point p) {
-
-//        double r = outerRadius();
-//        double sinA = a / (2. * r);
-//        double sinB = b / (2. * r);
-//        double sinC = c / (2. * r);
-//
-//        double cosA = (b * b + c * c - a * a) / (2. * b * c);
-//        double cosB = (a * a + c * c - b * b) / (2. * a * c);
-//        double cosC = (a * a + b * b - c * c) / (2. * a * b);
-//
-//        float sin2A = 2. * sinA * cosA;
-//        float sin2B = 2. * sinB * cosB;
-//        float sin2C = 2. * sinC * cosC;
-//
-//        glm::vec3 c_o = (sin2A * glm::vec3(l3.p1.x, l3.p1.y, l3.p1.z) + sin2B * glm::vec3(l1.p1.x, l1.p1.y, l1.p1.z) + sin2C * glm::vec3(l2.p1.x, l2.p1.y, l2.p1.z)) / (sin2A + sin2B + sin2C);
+    // whether p lies strictly inside the circumcircle, in the xy-plane; widening to double is exact
+    bool inside(const Point<T, I>& p) const {
+        const double pa[2] = {(double)l1.p1.x, (double)l1.p1.y}, pb[2] = {(double)l2.p1.x, (double)l2.p1.y};
+        const double pc[2] = {(double)l3.p1.x, (double)l3.p1.y}, pd[2] = {(double)p.x, (double)p.y};
+        double o = orient2d(pa, pb, pc);
+        if(o == 0.) return false;
 
-        double a[3] = {l1.p1.x, l1.p1.y, l1.p1.z}, b[3] = {l2.p1.x, l2.p1.y, l2.p1.z} , c[3] = {l3.p1.x, l3.p1.y, l3.p1.z}, cumcen[3] = {0., 0., 0.};
-        tricircumcenter3d(a, b, c, cumcen, nullptr, nullptr);
-
-        cumcen[0] += a[0];
-        cumcen[1] += a[1];
-        cumcen[2] += a[2];
-
-        Edge temp(Point(cumcen[0], cumcen[1], cumcen[2]), l3.p1);
-        double r_ = temp.length();
-
-        Edge e(Point(cumcen[0], cumcen[1], cumcen[2]), p);
-//        if(e.length() < outerRadius()) return true;
-        if(e.length() < r_) return true;
-        else return false;
+        double ic = incircle(pa, pb, pc, pd);
+        return o > 0. ? ic > 0. : ic < 0.;
     }
 
     void tricircumcenter3d(double a[3], double b[3], double c[3], double* circumcenter,
@@ -153,6 +143,9 @@ struct Triangle {
         double xcrossbc, ycrossbc, zcrossbc;
         double denominator;
         double xcirca, ycirca, zcirca;
+#ifdef EXACT
+        double A[2], B[2], C[2];
+#endif
 
         /* Use coordinates relative to point `a' of the triangle. */
         xba = b[0] - a[0];
@@ -239,20 +232,90 @@ struct Triangle {
     }
 };
 
+enum class Algorithm {
+    AdvancingFront,     // empty-circle growth from the closest pair, or from many seeds in parallel
+    BowyerWatson,       // incremental insertion, expected O(n log n)
+    DivideConquer,      // Guibas-Stolfi on a quad-edge structure, worst-case O(n log n)
+    SweepHull,          // radial sweep with flips on flat half-edge arrays
+    Auto                // chosen by generateTIN from a sample of the input, with the reasons logged
+};
+
+template<typename T>
 struct Bound {
-    float x_min{std::numeric_limits<float>::max()}, x_max{std::numeric_limits<float>::lowest()};
-    float y_min{std::numeric_limits<float>::max()}, y_max{std::numeric_limits<float>::lowest()};
-    float z_min{std::numeric_limits<float>::max()}, z_max{std::numeric_limits<float>::lowest()};
+    T x_min{std::numeric_limits<T>::max()}, x_max{std::numeric_limits<T>::lowest()};
+    T y_min{std::numeric_limits<T>::max()}, y_max{std::numeric_limits<T>::lowest()};
+    T z_min{std::numeric_limits<T>::max()}, z_max{std::numeric_limits<T>::lowest()};
 };
 
+/*
+ * Delaunay<Coord, Index>: Coord is the coordinate type of the stored points, Index the type of the
+ * vertex ids and of the triIDs index buffer. Delaunay<double, uint32_t> for production,
+ * Delaunay<float, uint16_t> for small tiles of at most 65535 points. The engines work on widened double
+ * coordinates and 32-bit ids internally, with the predicate family picked by the snap resolution
+ * (Arithmetic); instantiations for float/double and 16/32/64-bit indices are compiled in Delaunay.cpp.
+ */
+template<typename Coord = float, typename Index = unsigned int>
 class Delaunay {
+    static_assert(std::is_floating_point<Coord>::value, "Coord must be a floating-point type");
+    static_assert(std::is_unsigned<Index>::value, "Index must be an unsigned integer type");
+
+public:
+    using Vertex = Point<Coord, Index>;
+
 private:
-    std::vector<Point> points;
-    std::vector<float> p_z;
-    Bound bound;
+    std::vector<Vertex> points;
+    std::vector<Coord> p_z;
+    Bound<Coord> bound;
     int dim {4};
+    Algorithm algorithm {Algorithm::Auto};
+    unsigned int threadCount {std::max(1u, std::thread::hardware_concurrency())};
+    unsigned int threads {1};           // threads of the running generateTIN, at most threadCount
+    Coord snapResolution {0};           // grid step of the snapped mode, 0 when off
+    Coord snapOrigin[2] {0, 0};         // lower left corner the snapped grid was laid from
+    Arithmetic arithmetic {Arithmetic::Adaptive};
+
+    HalfEdgeMesh mesh;                  // triangulation of the last generateTIN
+    Lattice lattice;                    // grid nodes of the points as read, empty unless they form a grid
+    Hierarchy hierarchy;
+    std::vector<uint32_t> permutation;  // hierarchy vertex -> file id
+    std::vector<uint32_t> inverse;      // file id -> hierarchy vertex
+    std::vector<char> removed;          // points taken out by remove, empty while there are none
+    std::multimap<uint32_t, uint32_t> hidden;   // hierarchy vertex -> file ids repeating its position
+    std::vector<std::vector<Coord>> breaklines; // x / y pairs of the constraints of generateTIN
+    std::vector<std::vector<Coord>> boundaries;
+    double minAngle {0};                // refinement bounds of generateTIN, 0 when off
+    double maxArea {0};
+
+    // insert / remove keep mesh equal to the finite triangles of the hierarchy's base level
+    bool dynamic {false};
+    std::vector<uint32_t> slotTriangle; // base triangle -> mesh triangle, INVALID for ghosts and free slots
+    std::vector<uint32_t> triangleSlot; // mesh triangle -> base triangle
     void readFile(std::string path);
 
+    void advancingFront();
+    void bowyerWatson();
+    void divideConquer();
+    void sweepHull();
+    Algorithm plan();
+    std::vector<double> planarCoords();
+    double snap(Coord v, Coord origin) const;
+    void buildHierarchy();
+    uint32_t holder(uint32_t v);
+    uint32_t walkMesh(double x, double y) const;
+    void meshFromHierarchy();
+    void constrainedTIN();
+    uint32_t constraintVertex(Coord x, Coord y);
+    void refine(Triangulation& base, Constrained& cdt);
+    void startDynamic(std::vector<Index>& triIDs);
+    void updateMesh(std::vector<Index>& triIDs);
+    void attach(Index id, std::vector<Index>& triIDs);
+    bool detach(Index id, std::vector<Index>& triIDs);
+    void compact();
+    bool isRemoved(size_t i) const { return !removed.empty() && removed[i]; }
+    glm::vec3 faceNormal(unsigned int a, unsigned int b, unsigned int c) const;
+    void computeNormals();
+    void computeNormal(unsigned int v);
+
     int getIndex(int i, int j, int size);
     void getIJ(int index, int& i, int& j, int size);
 
@@ -264,8 +327,63 @@ public:
 
     ~Delaunay() { }
 
-    void generateTIN(std::vector<unsigned int>& triIDs);
+    void setAlgorithm(Algorithm _algorithm) { algorithm = _algorithm; }
+    void setThreadCount(unsigned int _threadCount) { threadCount = std::max(1u, _threadCount); }
+    // snap x / y to a grid of this step relative to (x_min, y_min) and decide every predicate with exact
+    // integer arithmetic; e.g. 0.001 for millimeter survey data, 0 turns it off
+    void setSnapResolution(Coord resolution) {
+        snapResolution = std::max(Coord(0), resolution);
+        hierarchy = Hierarchy();
+        dynamic = false;
+    }
+    void generateTIN(std::vector<Index>& triIDs);
+    // 3D Delaunay tetrahedralization of the points with their z, e.g. geology volumes: tetIDs gets four
+    // point indices per tetrahedron, positively oriented by orient3d. Repeated points are left out, and
+    // everything if all points are coplanar. Independent of the TIN, the snap resolution and constraints.
+    void generateTetrahedra(std::vector<Index>& tetIDs);
+    // constraints of every following generateTIN, as polylines of x / y pairs. A breakline becomes a chain
+    // of triangle edges. A boundary ring, closed automatically, does too and cuts the TIN: triangles
+    // outside an odd number of rings, i.e. outside the outer boundary or inside a hole, are dropped.
+    // Vertices that are not input points are added as points, with z from the unconstrained triangulation.
+    // insert / remove / move go back to the unconstrained Delaunay triangulation.
+    void addBreakline(std::vector<Coord> xy) { breaklines.push_back(std::move(xy)); }
+    void addBoundary(std::vector<Coord> xy) { boundaries.push_back(std::move(xy)); }
+    void clearConstraints() {
+        breaklines.clear();
+        boundaries.clear();
+    }
+    // refine every following generateTIN, within the boundaries if there are any, with Steiner points
+    // until no triangle has an angle below minAngle degrees or an area above maxArea; 0 turns a bound off.
+    // Sharper angles between two constraints or hull edges stay, bounds beyond ~30 degrees may run into the
+    // cap on Steiner points. Those are added as points with interpolated z. Needs the adaptive predicates,
+    // i.e. no snap resolution.
+    void setRefinement(double _minAngle, double _maxArea) {
+        minAngle = std::min(std::max(0., _minAngle), 60.);
+        maxArea = std::max(0., _maxArea);
+    }
+    // load the z column of a repeat survey in readFile's format. If every x / y is unchanged the
+    // triangulation and triIDs are kept and only the normals are recomputed, in parallel; otherwise the
+    // file replaces the points and triIDs is generated again. true when the connectivity was reused.
+    bool updateHeights(std::string path, std::vector<Index>& triIDs);
+    // flip the edges of any triangulation of these points (e.g. a previous run or an export) until it is
+    // Delaunay, triIDs is rewritten in place
+    void legalize(std::vector<Index>& triIDs);
+    // add a point / take point id out and retriangulate only its cavity / star. triIDs is the buffer of
+    // the last generateTIN, legalize, insert or remove and is patched in place: dropped triangles are
+    // swapped with the last one, new triangles appended. The first call after generateTIN switches the
+    // mesh over to the Bowyer-Watson hierarchy, which is one full rebuild unless that was the algorithm.
+    // Removed points keep their index until the next generateTIN compacts them away.
+    Index insert(Coord x, Coord y, Coord z, std::vector<Index>& triIDs);
+    bool remove(Index id, std::vector<Index>& triIDs);
+    // relocate point id in the xy-plane and repair the Delaunay property with flips around it; a move
+    // that leaves the star or touches the hull falls back to taking the point out and putting it back
+    bool move(Index id, Coord x, Coord y, std::vector<Index>& triIDs);
     void getVertices(std::vector<float>& vertices);
+    const HalfEdgeMesh& getMesh() const { return mesh; }
+    // vertex ids of the triangle containing (x, y), false outside the convex hull. Without a hierarchy
+    // the mesh of the last generateTIN is searched by jump-and-walk, the hierarchy is only built for
+    // points the walk cannot reach
+    bool locate(Coord x, Coord y, Index& a, Index& b, Index& c);
     int getSize() { return points.size() * dim * sizeof(float); };
     int getPointSize() { return points.size(); };
 };
@@ -0,0 +1,214 @@
+//
+// Created by lc06 on 4/19/2023.
+//
+
+#include "DivideConquer.h"
+#include "Predicates.h"
+
+#include <thread>
+
+template<typename K>
+bool DivideConquer<K>::ccw(uint32_t a, uint32_t b, uint32_t c) const {
+    return K::orient2d(point(a), point(b), point(c)) > 0.;
+}
+
+template<typename K>
+bool DivideConquer<K>::inCircle(uint32_t a, uint32_t b, uint32_t c, uint32_t d) const {
+    return incirclePerturbed<K>(point(a), point(b), point(c), point(d)) > 0.;
+}
+
+template<typename K>
+uint32_t DivideConquer<K>::allocate(Arena& arena) {
+    uint32_t q;
+    if(!arena.freed.empty()) {
+        q = arena.freed.back();
+        arena.freed.pop_back();
+    }
+    else {
+        auto& range = arena.ranges.back();
+        q = range.first++;
+        if(range.first == range.second) arena.ranges.pop_back();
+    }
+
+    return q;
+}
+
+template<typename K>
+void DivideConquer<K>::deleteEdge(Arena& arena, uint32_t e) {
+    mesh.deleteEdge(e);
+    arena.freed.push_back(e / 4);
+}
+
+template<typename K>
+void DivideConquer<K>::triangulate(std::vector<unsigned int>& triIDs) {
+    uint32_t n = coords.size() / 2;
+
+    unsigned int depth = 0;
+    while((1u << depth) < threads) depth++;
+
+    sorted.resize(n);
+    for(uint32_t i = 0; i < n; ++i) sorted[i] = i;
+    sort(0, n, depth);
+    sorted.erase(std::unique(sorted.begin(), sorted.end(), [this](uint32_t a, uint32_t b) {
+        return coords[2 * a] == coords[2 * b] && coords[2 * a + 1] == coords[2 * b + 1];
+    }), sorted.end());
+
+    if(sorted.size() < 3) return;
+
+    // a planar straight-line graph never holds more than 3n edges at once, plus slack for every worker
+    uint32_t capacity = 3 * sorted.size() + (6u << depth);
+    Arena arena {{{0, capacity}}, {}};
+    mesh.resize(capacity);
+
+    build(0, sorted.size(), arena, depth);
+    collect(triIDs);
+}
+
+template<typename K>
+void DivideConquer<K>::sort(size_t lo, size_t hi, unsigned int depth) {
+    auto less = [this](uint32_t a, uint32_t b) {
+        return coords[2 * a] < coords[2 * b] || (coords[2 * a] == coords[2 * b] && coords[2 * a + 1] < coords[2 * b + 1]);
+    };
+
+    if(depth == 0 || hi - lo < 4096) {
+        std::sort(sorted.begin() + lo, sorted.begin() + hi, less);
+        return;
+    }
+
+    size_t mid = lo + (hi - lo) / 2;
+    std::thread worker(&DivideConquer::sort, this, lo, mid, depth - 1);
+    sort(mid, hi, depth - 1);
+    worker.join();
+
+    std::inplace_merge(sorted.begin() + lo, sorted.begin() + mid, sorted.begin() + hi, less);
+}
+
+template<typename K>
+std::pair<uint32_t, uint32_t> DivideConquer<K>::build(size_t lo, size_t hi, Arena& arena, unsigned int depth) {
+    size_t size = hi - lo;
+
+    if(size == 2) {
+        uint32_t a = mesh.makeEdge(allocate(arena), sorted[lo], sorted[lo + 1]);
+        return {a, QuadEdge::sym(a)};
+    }
+
+    if(size == 3) {
+        uint32_t s1 = sorted[lo], s2 = sorted[lo + 1], s3 = sorted[lo + 2];
+        uint32_t a = mesh.makeEdge(allocate(arena), s1, s2);
+        uint32_t b = mesh.makeEdge(allocate(arena), s2, s3);
+        mesh.splice(QuadEdge::sym(a), b);
+
+        if(ccw(s1, s2, s3)) {
+            mesh.connect(allocate(arena), b, a);
+            return {a, QuadEdge::sym(b)};
+        }
+        if(ccw(s1, s3, s2)) {
+            uint32_t c = mesh.connect(allocate(arena), b, a);
+            return {QuadEdge::sym(c), c};
+        }
+        return {a, QuadEdge::sym(b)};
+    }
+
+    size_t mid = lo + size / 2;
+
+    if(depth == 0 || size < 4096) {
+        auto [ldo, ldi] = build(lo, mid, arena, 0);
+        auto [rdi, rdo] = build(mid, hi, arena, 0);
+        return merge(ldo, ldi, rdi, rdo, arena);
+    }
+
+    // hand the upper part of this task's quad-edges to the right half
+    auto& range = arena.ranges.back();
+    uint32_t split = range.first + 3 * (mid - lo) + (6u << (depth - 1));
+
+    Arena right {{{split, range.second}}, {}};
+    range.second = split;
+
+    std::pair<uint32_t, uint32_t> left;
+    std::thread worker([&]() { left = build(lo, mid, arena, depth - 1); });
+    auto [rdi, rdo] = build(mid, hi, right, depth - 1);
+    worker.join();
+
+    arena.absorb(right);
+    return merge(left.first, left.second, rdi, rdo, arena);
+}
+
+template<typename K>
+std::pair<uint32_t, uint32_t> DivideConquer<K>::merge(uint32_t ldo, uint32_t ldi, uint32_t rdi, uint32_t rdo, Arena& arena) {
+    // lower common tangent of the two hulls
+    while(true) {
+        if(leftOf(mesh.org(rdi), ldi)) ldi = mesh.lnext(ldi);
+        else if(rightOf(mesh.org(ldi), rdi)) rdi = mesh.rprev(rdi);
+        else break;
+    }
+
+    uint32_t basel = mesh.connect(allocate(arena), QuadEdge::sym(rdi), ldi);
+    if(mesh.org(ldi) == mesh.org(ldo)) ldo = QuadEdge::sym(basel);
+    if(mesh.org(rdi) == mesh.org(rdo)) rdo = basel;
+
+    // zip upwards, deleting left and right edges that fail the empty-circle test
+    while(true) {
+        uint32_t lcand = mesh.next(QuadEdge::sym(basel));
+        bool lvalid = rightOf(mesh.dest(lcand), basel);
+        if(lvalid) {
+            while(inCircle(mesh.dest(basel), mesh.org(basel), mesh.dest(lcand), mesh.dest(mesh.next(lcand)))) {
+                uint32_t t = mesh.next(lcand);
+                deleteEdge(arena, lcand);
+                lcand = t;
+            }
+        }
+
+        uint32_t rcand = mesh.oprev(basel);
+        bool rvalid = rightOf(mesh.dest(rcand), basel);
+        if(rvalid) {
+            while(inCircle(mesh.dest(basel), mesh.org(basel), mesh.dest(rcand), mesh.dest(mesh.oprev(rcand)))) {
+                uint32_t t = mesh.oprev(rcand);
+                deleteEdge(arena, rcand);
+                rcand = t;
+            }
+        }
+
+        if(!lvalid && !rvalid) break;
+
+        if(!lvalid || (rvalid && inCircle(mesh.dest(lcand), mesh.org(lcand), mesh.org(rcand), mesh.dest(rcand))))
+            basel = mesh.connect(allocate(arena), rcand, QuadEdge::sym(basel));
+        else
+            basel = mesh.connect(allocate(arena), QuadEdge::sym(basel), QuadEdge::sym(lcand));
+    }
+
+    return {ldo, rdo};
+}
+
+template<typename K>
+void DivideConquer<K>::collect(std::vector<unsigned int>& triIDs) {
+    uint32_t edges = mesh.onext.size();
+    uint32_t chunk = (edges / 4 + threads - 1) / threads * 4;
+
+    // every triangle is reported by its lowest primal half-edge only
+    std::vector<std::vector<unsigned int>> parts(threads);
+    auto work = [&](unsigned int k) {
+        for(uint32_t e = k * chunk; e < std::min(edges, (k + 1) * chunk); e += 2) {
+            if(!mesh.isAlive(e / 4)) continue;
+
+            uint32_t e1 = mesh.lnext(e), e2 = mesh.lnext(e1);
+            if(mesh.lnext(e2) != e || e1 < e || e2 < e) continue;
+
+            uint32_t a = mesh.org(e), b = mesh.org(e1), c = mesh.org(e2);
+            if(!ccw(a, b, c)) continue;
+
+            parts[k].push_back(a);
+            parts[k].push_back(b);
+            parts[k].push_back(c);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for(unsigned int k = 1; k < threads; ++k) workers.emplace_back(work, k);
+    work(0);
+    for(auto& worker : workers) worker.join();
+
+    for(auto& part : parts) triIDs.insert(triIDs.end(), part.begin(), part.end());
+}
+
+template class DivideConquer<AdaptiveKernel>;
+template class DivideConquer<SnappedKernel>;
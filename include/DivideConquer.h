@@ -0,0 +1,65 @@
+//
+// Created by lc06 on 4/19/2023.
+//
+
+#ifndef DELAUNAY_DIVIDECONQUER_H
+#define DELAUNAY_DIVIDECONQUER_H
+
+#include "QuadEdge.h"
+#include "Predicates.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/*
+ * Guibas-Stolfi divide-and-conquer Delaunay triangulation, worst-case O(n log n).
+ *
+ * Points are sorted by x then y and split in halves, each half is triangulated recursively and the two
+ * triangulations are stitched together bottom-up along their common tangent. With more than one thread
+ * the upper levels of the recursion run the left half on a worker thread, so independent halves are
+ * triangulated and merged concurrently; every worker owns a disjoint range of quad-edges. K is the
+ * predicate kernel, AdaptiveKernel or SnappedKernel.
+ */
+template<typename K>
+class DivideConquer {
+public:
+    explicit DivideConquer(const std::vector<double>& _coords, unsigned int _threads = 1)
+        : coords(_coords), threads(std::max(1u, _threads)) {}
+
+    void triangulate(std::vector<unsigned int>& triIDs);
+
+private:
+    // quad-edges handed out from the front of the ranges and recycled after deletion
+    struct Arena {
+        std::vector<std::pair<uint32_t, uint32_t>> ranges;
+        std::vector<uint32_t> freed;
+
+        void absorb(Arena& other) {
+            ranges.insert(ranges.end(), other.ranges.begin(), other.ranges.end());
+            freed.insert(freed.end(), other.freed.begin(), other.freed.end());
+        }
+    };
+
+    const std::vector<double>& coords;
+    unsigned int threads;
+    std::vector<uint32_t> sorted;
+    QuadEdge mesh;
+
+    void sort(size_t lo, size_t hi, unsigned int depth);
+    std::pair<uint32_t, uint32_t> build(size_t lo, size_t hi, Arena& arena, unsigned int depth);
+    std::pair<uint32_t, uint32_t> merge(uint32_t ldo, uint32_t ldi, uint32_t rdi, uint32_t rdo, Arena& arena);
+    void collect(std::vector<unsigned int>& triIDs);
+
+    uint32_t allocate(Arena& arena);
+    void deleteEdge(Arena& arena, uint32_t e);
+
+    const double* point(uint32_t v) const { return &coords[2 * v]; }
+    bool ccw(uint32_t a, uint32_t b, uint32_t c) const;
+    bool rightOf(uint32_t v, uint32_t e) const { return ccw(v, mesh.dest(e), mesh.org(e)); }
+    bool leftOf(uint32_t v, uint32_t e) const { return ccw(v, mesh.org(e), mesh.dest(e)); }
+    bool inCircle(uint32_t a, uint32_t b, uint32_t c, uint32_t d) const;
+};
+
+
+#endif //DELAUNAY_DIVIDECONQUER_H
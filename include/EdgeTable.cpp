@@ -0,0 +1,87 @@
+//
+// Created by lc06 on 4/26/2023.
+//
+
+#include "EdgeTable.h"
+
+EdgeTable::EdgeTable(size_t expected) {
+    capacity = 16;
+    while(capacity < 2 * expected) capacity *= 2;
+    slots.reset(new Slot[capacity]);
+}
+
+uint64_t EdgeTable::hash(uint64_t k) {
+    // splitmix64 finalizer
+    k ^= k >> 30;
+    k *= 0xbf58476d1ce4e5b9ull;
+    k ^= k >> 27;
+    k *= 0x94d049bb133111ebull;
+    k ^= k >> 31;
+    return k;
+}
+
+size_t EdgeTable::probe(uint64_t k) const {
+    size_t mask = capacity - 1;
+    size_t i = hash(k) & mask;
+    while(true) {
+        uint64_t key = slots[i].key.load(std::memory_order_acquire);
+        if(key == EMPTY || key == k) return i;
+        i = (i + 1) & mask;
+    }
+}
+
+EdgeTable::Slot& EdgeTable::insert(uint64_t k) {
+    if(2 * (count + 1) > capacity) grow();
+
+    size_t mask = capacity - 1;
+    size_t i = hash(k) & mask;
+    while(true) {
+        uint64_t key = slots[i].key.load(std::memory_order_acquire);
+        if(key == k) return slots[i];
+
+        // take the empty slot, or learn which key another thread put there
+        if(key == EMPTY && slots[i].key.compare_exchange_strong(key, k, std::memory_order_acq_rel)) {
+            count++;
+            return slots[i];
+        }
+        if(key == k) return slots[i];
+
+        i = (i + 1) & mask;
+    }
+}
+
+EdgeTable::Sides EdgeTable::get(uint32_t a, uint32_t b) const {
+    const Slot& slot = slots[probe(key(a, b))];
+
+    Sides sides;
+    if(slot.key.load(std::memory_order_acquire) == EMPTY) return sides;
+    sides.apex[0] = slot.apex[0].load(std::memory_order_acquire);
+    sides.apex[1] = slot.apex[1].load(std::memory_order_acquire);
+    return sides;
+}
+
+void EdgeTable::set(uint32_t a, uint32_t b, int side, uint32_t apex) {
+    insert(key(a, b)).apex[side].store(apex, std::memory_order_release);
+}
+
+bool EdgeTable::claim(uint32_t a, uint32_t b, int side, uint32_t apex) {
+    uint32_t expected = INVALID;
+    return insert(key(a, b)).apex[side].compare_exchange_strong(expected, apex, std::memory_order_acq_rel);
+}
+
+void EdgeTable::grow() {
+    std::unique_ptr<Slot[]> old(new Slot[2 * capacity]);
+    old.swap(slots);
+    size_t oldCapacity = capacity;
+    capacity *= 2;
+
+    for(size_t i = 0; i < oldCapacity; ++i) {
+        uint64_t k = old[i].key.load(std::memory_order_relaxed);
+        if(k == EMPTY) continue;
+
+        Slot& slot = slots[probe(k)];
+        slot.key.store(k, std::memory_order_relaxed);
+        slot.apex[0].store(old[i].apex[0].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        slot.apex[1].store(old[i].apex[1].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
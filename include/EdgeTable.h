@@ -0,0 +1,70 @@
+//
+// Created by lc06 on 4/26/2023.
+//
+
+#ifndef DELAUNAY_EDGETABLE_H
+#define DELAUNAY_EDGETABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/*
+ * Open-addressing table of the undirected edges built by the advancing front.
+ *
+ * An edge is keyed by its sorted vertex pair and remembers the apex of the triangle on each side:
+ * side 0 lies left of min -> max, side 1 right of it. A side is INVALID while it is still open and
+ * OUTSIDE once nothing can be built there (the exterior of the convex hull), so the number of used
+ * sides tells whether the edge still belongs to the frontier. Linear probing, kept at most half full.
+ *
+ * Keys and sides are atomics, so several fronts can share the table: keys are inserted with a
+ * compare-and-swap and claim() lets exactly one thread take an open side. Growing is not thread-safe,
+ * concurrent users have to size the table for all of their edges up front.
+ */
+class EdgeTable {
+public:
+    static constexpr uint32_t INVALID = 0xFFFFFFFF;
+    static constexpr uint32_t OUTSIDE = 0xFFFFFFFE;
+
+    struct Sides {
+        uint32_t apex[2] {INVALID, INVALID};
+
+        int uses() const { return (apex[0] != INVALID) + (apex[1] != INVALID); }
+        bool isOpen() const { return uses() < 2; }
+    };
+
+    explicit EdgeTable(size_t expected = 0);
+
+    // sides of edge ab, both open if it was never seen
+    Sides get(uint32_t a, uint32_t b) const;
+    // record apex (or OUTSIDE) on the given side of ab, sides are relative to min(a, b) -> max(a, b)
+    void set(uint32_t a, uint32_t b, int side, uint32_t apex);
+    // record apex on the given side of ab if that side is still open, false if another apex got there first
+    bool claim(uint32_t a, uint32_t b, int side, uint32_t apex);
+
+    size_t size() const { return count; }
+
+private:
+    static constexpr uint64_t EMPTY = ~0ull;
+
+    struct Slot {
+        std::atomic<uint64_t> key {EMPTY};
+        std::atomic<uint32_t> apex[2] {{INVALID}, {INVALID}};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t capacity {0};
+    std::atomic<size_t> count {0};
+
+    static uint64_t key(uint32_t a, uint32_t b) { return a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a; }
+    static uint64_t hash(uint64_t k);
+    // slot holding k, or the empty slot where it belongs
+    size_t probe(uint64_t k) const;
+    // slot holding k, inserting it if needed
+    Slot& insert(uint64_t k);
+    void grow();
+};
+
+
+#endif //DELAUNAY_EDGETABLE_H
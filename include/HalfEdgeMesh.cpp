@@ -0,0 +1,35 @@
+//
+// Created by lc06 on 4/25/2023.
+//
+
+#include "HalfEdgeMesh.h"
+
+#include <algorithm>
+#include <utility>
+
+void HalfEdgeMesh::build(std::vector<unsigned int> _triangles) {
+    triangles = std::move(_triangles);
+    halfedges.assign(triangles.size(), INVALID);
+
+    // sort the half-edges by their undirected edge, twins end up next to each other
+    std::vector<std::pair<uint64_t, uint32_t>> keys(triangles.size());
+    for(uint32_t e = 0; e < triangles.size(); ++e) {
+        uint64_t a = triangles[e], b = triangles[next(e)];
+        keys[e] = {a < b ? a << 32 | b : b << 32 | a, e};
+    }
+    std::sort(keys.begin(), keys.end());
+
+    for(size_t i = 0; i + 1 < keys.size(); ++i) {
+        if(keys[i].first != keys[i + 1].first) continue;
+
+        // only a manifold pair of opposite half-edges are twins
+        uint32_t e1 = keys[i].second, e2 = keys[i + 1].second;
+        bool manifold = (i + 2 >= keys.size() || keys[i + 2].first != keys[i].first) &&
+                        (i == 0 || keys[i - 1].first != keys[i].first);
+        if(manifold && triangles[e1] == triangles[next(e2)]) {
+            halfedges[e1] = e2;
+            halfedges[e2] = e1;
+        }
+        i++;
+    }
+}
@@ -0,0 +1,46 @@
+//
+// Created by lc06 on 4/25/2023.
+//
+
+#ifndef DELAUNAY_HALFEDGEMESH_H
+#define DELAUNAY_HALFEDGEMESH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Compact index-based half-edge mesh, 24 bytes per triangle.
+ *
+ * Half-edge e belongs to triangle e / 3 and starts at vertex triangles[e]; next and prev stay inside the
+ * triangle, halfedges[e] is the twin in the neighbouring triangle or INVALID on the boundary.
+ * triangles doubles as the triIDs index buffer.
+ */
+struct HalfEdgeMesh {
+    static constexpr uint32_t INVALID = 0xFFFFFFFF;
+
+    std::vector<unsigned int> triangles;
+    std::vector<uint32_t> halfedges;
+
+    static uint32_t next(uint32_t e) { return e % 3 == 2 ? e - 2 : e + 1; }
+    static uint32_t prev(uint32_t e) { return e % 3 == 0 ? e + 2 : e - 1; }
+
+    size_t triangleCount() const { return triangles.size() / 3; }
+    uint32_t origin(uint32_t e) const { return triangles[e]; }
+    uint32_t twin(uint32_t e) const { return halfedges[e]; }
+    // triangle across edge i of triangle t, INVALID on the boundary
+    uint32_t neighbor(uint32_t t, uint32_t i) const {
+        return halfedges[3 * t + i] == INVALID ? INVALID : halfedges[3 * t + i] / 3;
+    }
+
+    void clear() {
+        triangles.clear();
+        halfedges.clear();
+    }
+
+    // take consistently oriented triangles and pair up their twins
+    void build(std::vector<unsigned int> _triangles);
+};
+
+
+#endif //DELAUNAY_HALFEDGEMESH_H
@@ -0,0 +1,100 @@
+//
+// Created by lc06 on 4/21/2023.
+//
+
+#include "Hierarchy.h"
+
+#include <algorithm>
+
+Hierarchy::Hierarchy(std::vector<double> coords) : levels(MAX_LEVELS), down(MAX_LEVELS), up(MAX_LEVELS) {
+    levels[0] = Triangulation(std::move(coords));
+}
+
+int Hierarchy::randomLevel() {
+    int level = 0;
+    while(level < MAX_LEVELS - 1) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        if(seed % RATIO != 0) break;
+        level++;
+    }
+    return level;
+}
+
+void Hierarchy::descend(double x, double y, uint32_t* hints) {
+    uint32_t hint = Triangulation::INVALID;
+
+    for(int k = MAX_LEVELS - 1; k >= 0; --k) {
+        uint32_t t = levels[k].locate(x, y, hint);
+        hints[k] = t;
+
+        hint = Triangulation::INVALID;
+        if(k > 0 && t != Triangulation::INVALID) {
+            uint32_t v = down[k][levels[k].nearestVertex(t, x, y)];
+            if(levels[k - 1].vertexEdge[v] != Triangulation::INVALID) hint = levels[k - 1].vertexEdge[v] / 3;
+        }
+    }
+}
+
+bool Hierarchy::insert(uint32_t v) {
+    double x = levels[0].coords[2 * v], y = levels[0].coords[2 * v + 1];
+
+    uint32_t hints[MAX_LEVELS];
+    descend(x, y, hints);
+
+    if(!levels[0].insert(v, hints[0])) return false;
+
+    int level = randomLevel();
+    uint32_t w = v;
+    for(int k = 1; k <= level; ++k) {
+        uint32_t u = levels[k].addVertex(x, y);
+        down[k].push_back(w);
+        if(up[k - 1].size() <= w) up[k - 1].resize(w + 1, Triangulation::INVALID);
+        up[k - 1][w] = u;
+        levels[k].insert(u, hints[k]);
+        w = u;
+    }
+    return true;
+}
+
+bool Hierarchy::remove(uint32_t v) {
+    if(!levels[0].remove(v)) return false;
+
+    // the upper levels only guide point location, a vertex they cannot give up does no harm there
+    for(int k = 0; k + 1 < MAX_LEVELS && v < up[k].size() && up[k][v] != Triangulation::INVALID; ++k) {
+        uint32_t u = up[k][v];
+        up[k][v] = Triangulation::INVALID;
+        levels[k + 1].remove(u);
+        v = u;
+    }
+    return true;
+}
+
+uint32_t Hierarchy::locate(double x, double y) {
+    uint32_t hints[MAX_LEVELS];
+    descend(x, y, hints);
+    return hints[0];
+}
+
+bool Hierarchy::move(uint32_t v, double x, double y) {
+    if(!levels[0].move(v, x, y)) return false;
+
+    // the copies on the upper levels are taken out and inserted again at the new position
+    for(int k = 0; k + 1 < MAX_LEVELS && v < up[k].size() && up[k][v] != Triangulation::INVALID; ++k) {
+        uint32_t u = up[k][v];
+        levels[k + 1].remove(u);
+
+        uint32_t w = levels[k + 1].addVertex(x, y);
+        down[k + 1].push_back(v);
+        up[k][v] = w;
+        if(u < up[k + 1].size()) {
+            up[k + 1].resize(std::max<size_t>(up[k + 1].size(), w + 1), Triangulation::INVALID);
+            up[k + 1][w] = up[k + 1][u];
+            up[k + 1][u] = Triangulation::INVALID;
+        }
+        levels[k + 1].insert(w);
+        v = w;
+    }
+    return true;
+}
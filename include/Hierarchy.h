@@ -0,0 +1,53 @@
+//
+// Created by lc06 on 4/21/2023.
+//
+
+#ifndef DELAUNAY_HIERARCHY_H
+#define DELAUNAY_HIERARCHY_H
+
+#include "Triangulation.h"
+
+/*
+ * Delaunay hierarchy in the style of CGAL's Triangulation_hierarchy_2.
+ *
+ * Level 0 holds every vertex, each vertex climbs to the next level with probability 1 / RATIO. Point
+ * location walks the sparse top level first and enters every lower level at the vertex nearest to the
+ * query, so a walk never crosses more than a handful of triangles per level: O(log n) expected. The
+ * levels use the adaptive kernel, which is exact on snapped coordinates too, so one hierarchy serves both.
+ */
+class Hierarchy {
+public:
+    static constexpr int MAX_LEVELS = 5;
+    static constexpr uint32_t RATIO = 30;
+
+    Hierarchy() = default;
+    explicit Hierarchy(std::vector<double> coords);
+
+    bool empty() const { return levels.empty() || levels[0].triangles.empty(); }
+    Triangulation& base() { return levels[0]; }
+
+    // append a vertex to the base level without inserting it
+    uint32_t addVertex(double x, double y) { return levels[0].addVertex(x, y); }
+    // vertex v of the base level, false for duplicates
+    bool insert(uint32_t v);
+    // repeats among the base vertices held back until the last insert, see Triangulation::lastRepeats
+    const std::vector<uint32_t>& lastRepeats() const { return levels[0].lastRepeats(); }
+    // take vertex v of the base level out of every level it climbed to, false if the base level refuses
+    bool remove(uint32_t v);
+    // move vertex v of the base level to (x, y) with flips, see Triangulation::move
+    bool move(uint32_t v, double x, double y);
+    // triangle of the base level containing (x, y), or the ghost triangle whose outer half-plane contains it
+    uint32_t locate(double x, double y);
+
+private:
+    std::vector<Triangulation> levels;
+    std::vector<std::vector<uint32_t>> down;    // vertex of level k -> same vertex on level k - 1
+    std::vector<std::vector<uint32_t>> up;      // vertex of level k -> same vertex on level k + 1, if any
+    uint32_t seed {2463534242u};
+
+    int randomLevel();
+    void descend(double x, double y, uint32_t* hints);
+};
+
+
+#endif //DELAUNAY_HIERARCHY_H
@@ -0,0 +1,209 @@
+//
+// Created by lc06 on 4/24/2023.
+//
+
+#include "KdTree.h"
+#include "Predicates.h"
+#include "CircleKernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <utility>
+
+KdTree::KdTree(const std::vector<double>& _coords, Arithmetic _arithmetic) : coords(_coords), arithmetic(_arithmetic) {
+    uint32_t n = coords.size() / 2;
+
+    items.resize(n);
+    for(uint32_t i = 0; i < n; ++i) items[i] = i;
+
+    nodes.reserve(2 * (n / LEAF_SIZE + 1));
+    if(n > 0) build(0, n);
+
+    xs.resize(n);
+    ys.resize(n);
+    for(uint32_t i = 0; i < n; ++i) {
+        xs[i] = coords[2 * items[i]];
+        ys[i] = coords[2 * items[i] + 1];
+    }
+}
+
+uint32_t KdTree::build(uint32_t begin, uint32_t end) {
+    Node node {std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+               std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(),
+               begin, end, INVALID, INVALID};
+    for(uint32_t i = begin; i < end; ++i) {
+        node.x_min = std::min(node.x_min, coords[2 * items[i]]);
+        node.x_max = std::max(node.x_max, coords[2 * items[i]]);
+        node.y_min = std::min(node.y_min, coords[2 * items[i] + 1]);
+        node.y_max = std::max(node.y_max, coords[2 * items[i] + 1]);
+    }
+
+    uint32_t index = nodes.size();
+    nodes.push_back(node);
+    if(end - begin <= LEAF_SIZE) return index;
+
+    int axis = node.x_max - node.x_min >= node.y_max - node.y_min ? 0 : 1;
+    uint32_t mid = begin + (end - begin) / 2;
+    std::nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end, [&](uint32_t a, uint32_t b) {
+        return coords[2 * a + axis] < coords[2 * b + axis];
+    });
+
+    uint32_t left = build(begin, mid);
+    uint32_t right = build(mid, end);
+    nodes[index].left = left;
+    nodes[index].right = right;
+    return index;
+}
+
+double KdTree::distance(const Node& node, double x, double y) {
+    double dx = std::max(0., std::max(node.x_min - x, x - node.x_max));
+    double dy = std::max(0., std::max(node.y_min - y, y - node.y_max));
+    return dx * dx + dy * dy;
+}
+
+double KdTree::distance(const Node& node, double x0, double y0, double x, double y) {
+    // rounding is monotonic, so this never exceeds the distance circleMask computes for a point of the node
+    double dx = std::max(0., std::max((node.x_min - x0) - x, x - (node.x_max - x0)));
+    double dy = std::max(0., std::max((node.y_min - y0) - y, y - (node.y_max - y0)));
+    return dx * dx + dy * dy;
+}
+
+void KdTree::nearest(double x, double y, size_t k, std::vector<uint32_t>& result) const {
+    result.clear();
+    k = std::min(k, items.size());
+    if(k == 0) return;
+
+    // max-heap of the k best so far; ties are broken by id, so a smaller k always yields a prefix of a larger one
+    std::priority_queue<std::pair<double, uint32_t>> best;
+
+    uint32_t stack[128];
+    int top = 0;
+    stack[top++] = 0;
+    while(top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if(best.size() == k && distance(node, x, y) > best.top().first) continue;
+
+        if(node.left == INVALID) {
+            for(uint32_t i = node.begin; i < node.end; ++i) {
+                double dx = xs[i] - x, dy = ys[i] - y;
+                double d = dx * dx + dy * dy;
+                if(best.size() < k) best.emplace(d, items[i]);
+                else if(std::make_pair(d, items[i]) < best.top()) {
+                    best.pop();
+                    best.emplace(d, items[i]);
+                }
+            }
+            continue;
+        }
+
+        // nearer child on top of the stack
+        double dl = distance(nodes[node.left], x, y), dr = distance(nodes[node.right], x, y);
+        stack[top++] = dl <= dr ? node.right : node.left;
+        stack[top++] = dl <= dr ? node.left : node.right;
+    }
+
+    result.resize(best.size());
+    for(size_t i = best.size(); i > 0; --i) {
+        result[i - 1] = best.top().second;
+        best.pop();
+    }
+}
+
+bool KdTree::closestPair(uint32_t& a, uint32_t& b) const {
+    double bestDist = std::numeric_limits<double>::max();
+    bool found = false;
+
+    uint32_t stack[128];
+    for(uint32_t v = 0; v < items.size(); ++v) {
+        double x = coords[2 * v], y = coords[2 * v + 1];
+
+        int top = 0;
+        stack[top++] = 0;
+        while(top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if(distance(node, x, y) >= bestDist) continue;
+
+            if(node.left == INVALID) {
+                for(uint32_t i = node.begin; i < node.end; ++i) {
+                    double dx = xs[i] - x, dy = ys[i] - y;
+                    double d = dx * dx + dy * dy;
+                    if(d > 0. && d < bestDist) {
+                        bestDist = d;
+                        a = std::min(v, items[i]);
+                        b = std::max(v, items[i]);
+                        found = true;
+                    }
+                }
+                continue;
+            }
+
+            double dl = distance(nodes[node.left], x, y), dr = distance(nodes[node.right], x, y);
+            stack[top++] = dl <= dr ? node.right : node.left;
+            stack[top++] = dl <= dr ? node.left : node.right;
+        }
+    }
+    return found;
+}
+
+bool KdTree::anyInCircle(uint32_t a, uint32_t b, uint32_t c) const {
+    double orientation = orient2d(&coords[2 * a], &coords[2 * b], &coords[2 * c], arithmetic);
+    if(orientation == 0.) return true;
+    if(orientation < 0.) std::swap(b, c);
+
+    const double* pa = &coords[2 * a];
+    const double* pb = &coords[2 * b];
+    const double* pc = &coords[2 * c];
+
+    // circumcircle relative to a, so its rounding error scales with the triangle and not with the offset
+    // of the coordinates: the center (ox, oy) is off by at most ex / ey (first-order bounds on the roundings
+    // of the differences, lifts, numerators and d, doubled for the higher-order terms). Points are compared
+    // relative to a as well, and the radius is widened by both errors plus those of the comparison, so no
+    // point inside or on the true circle is filtered out. A det within twice its error bound turns it off.
+    const double eps = predicates::epsilon;
+    double bx = pb[0] - pa[0], by = pb[1] - pa[1];
+    double cx = pc[0] - pa[0], cy = pc[1] - pa[1];
+    double bl = bx * bx + by * by, cl = cx * cx + cy * cy;
+    double det = bx * cy - by * cx;
+    double detErr = 8. * eps * (std::fabs(bx * cy) + std::fabs(by * cx));
+    double d = 0.5 / det;
+    double ox = (cy * bl - by * cl) * d;
+    double oy = (bx * cl - cx * bl) * d;
+
+    double slack = std::numeric_limits<double>::infinity();
+    if(2. * detErr < std::fabs(det)) {
+        double shift = detErr / std::fabs(det) + 2. * eps;
+        double ex = 2. * (16. * eps * (std::fabs(cy) * bl + std::fabs(by) * cl) * std::fabs(d) + std::fabs(ox) * shift);
+        double ey = 2. * (16. * eps * (std::fabs(bx) * cl + std::fabs(cx) * bl) * std::fabs(d) + std::fabs(oy) * shift);
+        double radius = std::sqrt(ox * ox + oy * oy) * (1. + 16. * eps) + 2. * (ex + ey);
+        slack = radius * radius * (1. + 16. * eps);
+    }
+
+    uint32_t stack[128];
+    int top = 0;
+    stack[top++] = 0;
+    while(top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if(distance(node, pa[0], pa[1], ox, oy) > slack) continue;
+
+        if(node.left != INVALID) {
+            stack[top++] = node.left;
+            stack[top++] = node.right;
+            continue;
+        }
+
+        uint32_t mask = circleMask(&xs[node.begin], &ys[node.begin], node.end - node.begin, pa[0], pa[1], ox, oy, slack);
+        for(; mask != 0; mask &= mask - 1) {
+            uint32_t v = items[node.begin + lowestBit(mask)];
+            if(v == a || v == b || v == c) continue;
+
+            // copies of a, b or c are not in the way
+            const double* pv = &coords[2 * v];
+            if((pv[0] == pa[0] && pv[1] == pa[1]) || (pv[0] == pb[0] && pv[1] == pb[1]) || (pv[0] == pc[0] && pv[1] == pc[1])) continue;
+
+            if(incirclePerturbed(pa, pb, pc, pv, arithmetic) > 0.) return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,59 @@
+//
+// Created by lc06 on 4/24/2023.
+//
+
+#ifndef DELAUNAY_KDTREE_H
+#define DELAUNAY_KDTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Predicates.h"
+
+/*
+ * Static 2D kd-tree over the points for the advancing-front search.
+ *
+ * Nodes split the longer side of their bounding box at the median, leaves hold up to LEAF_SIZE points.
+ * Point ids and their coordinates are stored in leaf order (xs / ys), so every leaf is one contiguous
+ * block. Unlike a uniform grid the tree keeps its query cost on clustered inputs.
+ */
+class KdTree {
+public:
+    static constexpr uint32_t LEAF_SIZE = 16;
+    static constexpr uint32_t INVALID = 0xFFFFFFFF;
+
+    explicit KdTree(const std::vector<double>& _coords, Arithmetic _arithmetic = Arithmetic::Adaptive);
+
+    // closest pair of distinct positions, false when there is none
+    bool closestPair(uint32_t& a, uint32_t& b) const;
+    // the k points closest to (x, y), nearest first
+    void nearest(double x, double y, size_t k, std::vector<uint32_t>& result) const;
+    // whether any point at another position than a, b, c lies inside their circumcircle, points exactly
+    // on the circle decided by incirclePerturbed
+    bool anyInCircle(uint32_t a, uint32_t b, uint32_t c) const;
+
+    size_t size() const { return items.size(); }
+
+private:
+    struct Node {
+        double x_min, y_min, x_max, y_max;
+        uint32_t begin, end;        // range of items
+        uint32_t left, right;       // children, INVALID for leaves
+    };
+
+    const std::vector<double>& coords;
+    Arithmetic arithmetic;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> items;
+    std::vector<double> xs;
+    std::vector<double> ys;
+
+    uint32_t build(uint32_t begin, uint32_t end);
+    static double distance(const Node& node, double x, double y);
+    // squared distance from (x, y) to the node's box moved by -(x0, y0)
+    static double distance(const Node& node, double x0, double y0, double x, double y);
+};
+
+
+#endif //DELAUNAY_KDTREE_H
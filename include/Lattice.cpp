@@ -0,0 +1,144 @@
+//
+// Created by lc06 on 5/4/2023.
+//
+
+#include "Lattice.h"
+#include "Triangulation.h"
+
+#include <algorithm>
+#include <cmath>
+
+bool Lattice::detect(const std::vector<double>& coords) {
+    clear();
+    size_t n = coords.size() / 2;
+    if(n < 4) return false;
+
+    double x1 = x0 = coords[0], y1 = y0 = coords[1];
+    for(size_t k = 0; k < n; ++k) {
+        x0 = std::min(x0, coords[2 * k]), x1 = std::max(x1, coords[2 * k]);
+        y0 = std::min(y0, coords[2 * k + 1]), y1 = std::max(y1, coords[2 * k + 1]);
+    }
+    if(x1 <= x0 || y1 <= y0) return false;
+
+    // the spacing is the smallest offset from the lowest column / row, refined over the whole extent
+    auto spacing = [&](int axis, double origin, double extent) {
+        double step = extent;
+        for(size_t k = 0; k < n; ++k) {
+            double d = coords[2 * k + axis] - origin;
+            if(d > 1e-6 * extent && d < step) step = d;
+        }
+        return step;
+    };
+    double cols = std::round((x1 - x0) / spacing(0, x0, x1 - x0));
+    double rows = std::round((y1 - y0) / spacing(1, y0, y1 - y0));
+    if((cols + 1.) * (rows + 1.) > 2. * n) return false;
+
+    nx = uint32_t(cols) + 1, ny = uint32_t(rows) + 1;
+    dx = (x1 - x0) / cols, dy = (y1 - y0) / rows;
+
+    // a node off its column or row, or a missing one, leaves the mesh to be legalized
+    std::vector<double> columnX(nx, NAN), rowY(ny, NAN);
+    std::vector<uint32_t> taken((size_t)nx * ny, UINT32_MAX);      // first point at every node
+    exact = true;
+
+    nodes.resize(n);
+    for(size_t k = 0; k < n; ++k) {
+        double i = std::round((coords[2 * k] - x0) / dx), j = std::round((coords[2 * k + 1] - y0) / dy);
+        if(std::fabs(coords[2 * k] - (x0 + i * dx)) > 0.01 * dx || std::fabs(coords[2 * k + 1] - (y0 + j * dy)) > 0.01 * dy) {
+            clear();
+            return false;
+        }
+        nodes[k] = uint32_t(j) * nx + uint32_t(i);
+
+        // only exact repeats may share a node, triangulate keeps one point per node
+        uint32_t& first = taken[nodes[k]];
+        if(first == UINT32_MAX) first = uint32_t(k);
+        else if(coords[2 * first] != coords[2 * k] || coords[2 * first + 1] != coords[2 * k + 1]) {
+            clear();
+            return false;
+        }
+
+        double& x = columnX[uint32_t(i)];
+        double& y = rowY[uint32_t(j)];
+        if(std::isnan(x)) x = coords[2 * k];
+        if(std::isnan(y)) y = coords[2 * k + 1];
+        exact = exact && x == coords[2 * k] && y == coords[2 * k + 1];
+    }
+    exact = exact && std::none_of(taken.begin(), taken.end(), [](uint32_t k) { return k == UINT32_MAX; });
+    return true;
+}
+
+bool Lattice::triangulate(HalfEdgeMesh& mesh) const {
+    const uint32_t INVALID = Triangulation::INVALID;
+
+    // the lowest id at every node, repeated positions are left out as by the other algorithms
+    std::vector<uint32_t> occupant((size_t)nx * ny, INVALID);
+    for(uint32_t k = nodes.size(); k-- > 0;) occupant[nodes[k]] = k;
+
+    std::vector<double> coords(2 * occupant.size());
+    for(uint32_t j = 0; j < ny; ++j)
+        for(uint32_t i = 0; i < nx; ++i) {
+            coords[2 * (j * nx + i)] = i;
+            coords[2 * (j * nx + i) + 1] = j;
+        }
+
+    // cell (i, j) holds triangle 2c = (i, j) (i+1, j) (i+1, j+1) and 2c+1 = (i, j) (i+1, j+1) (i, j+1),
+    // c = j * cx + i; the ghost triangles of the boundary edges follow the cells
+    uint32_t cx = nx - 1, cy = ny - 1, cells = cx * cy, hull = 2 * (cx + cy);
+    std::vector<uint32_t> triangles(3 * (2 * cells + hull));
+    std::vector<uint32_t> halfedges(triangles.size());
+    auto lower = [cx](uint32_t i, uint32_t j) { return 6 * (j * cx + i); };
+    auto upper = [cx](uint32_t i, uint32_t j) { return 6 * (j * cx + i) + 3; };
+    auto link = [&halfedges](uint32_t e1, uint32_t e2) {
+        halfedges[e1] = e2;
+        halfedges[e2] = e1;
+    };
+
+    for(uint32_t j = 0; j < cy; ++j)
+        for(uint32_t i = 0; i < cx; ++i) {
+            uint32_t v00 = j * nx + i, v10 = v00 + 1, v01 = v00 + nx, v11 = v01 + 1;
+            uint32_t a = lower(i, j), b = upper(i, j);
+            triangles[a] = v00, triangles[a + 1] = v10, triangles[a + 2] = v11;
+            triangles[b] = v00, triangles[b + 1] = v11, triangles[b + 2] = v01;
+
+            link(a + 2, b);
+            if(j > 0) link(a, upper(i, j - 1) + 1);
+            if(i > 0) link(b + 2, lower(i - 1, j) + 1);
+        }
+
+    // boundary edges counterclockwise: bottom, right, top, left
+    std::vector<uint32_t> boundary;
+    boundary.reserve(hull);
+    for(uint32_t i = 0; i < cx; ++i) boundary.push_back(lower(i, 0));
+    for(uint32_t j = 0; j < cy; ++j) boundary.push_back(lower(cx - 1, j) + 1);
+    for(uint32_t i = cx; i-- > 0;) boundary.push_back(upper(i, cy - 1) + 1);
+    for(uint32_t j = cy; j-- > 0;) boundary.push_back(upper(0, j) + 2);
+
+    for(uint32_t k = 0; k < hull; ++k) {
+        uint32_t e = boundary[k], g = 3 * (2 * cells + k), previous = 3 * (2 * cells + (k + hull - 1) % hull);
+        triangles[g] = triangles[Triangulation::next(e)];
+        triangles[g + 1] = triangles[e];
+        triangles[g + 2] = Triangulation::INFINITE;
+        link(g, e);
+        link(g + 1, previous + 2);
+    }
+
+    BasicTriangulation<SnappedKernel> grid(std::move(coords));
+    grid.adopt(std::move(triangles), std::move(halfedges));
+
+    // the missing nodes go again, as long as their stars stay small
+    for(uint32_t v = 0; v < occupant.size(); ++v) {
+        if(occupant[v] != INVALID) continue;
+
+        uint32_t degree = 0, start = grid.vertexEdge[v], e = start;
+        do {
+            degree++;
+            e = grid.halfedges[Triangulation::prev(e)];
+        } while(e != start && degree <= MAX_STAR);
+        if(degree > MAX_STAR || !grid.remove(v)) return false;
+    }
+
+    grid.getMesh(mesh);
+    for(auto& v : mesh.triangles) v = occupant[v];
+    return true;
+}
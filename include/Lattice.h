@@ -0,0 +1,49 @@
+//
+// Created by lc06 on 5/4/2023.
+//
+
+#ifndef DELAUNAY_LATTICE_H
+#define DELAUNAY_LATTICE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "HalfEdgeMesh.h"
+
+/*
+ * Points on a regular grid x0 + i * dx, y0 + j * dy, such as DEM exports, possibly with missing nodes.
+ *
+ * Every grid cell has four cocircular corners, so splitting all cells along the same diagonal is a
+ * Delaunay triangulation and needs no predicate; the incircle tests the general algorithms would make
+ * are all exactly zero there. Missing nodes are taken out of the full grid again with
+ * Triangulation::remove, on the integer node coordinates, which fills holes and hull notches with
+ * Delaunay ears.
+ *
+ * That only holds for the real coordinates if every column has a single x and every row a single y and
+ * no node is missing, otherwise the cells are not exact rectangles or the ears were chosen on the integer
+ * grid; the mesh then still needs a Lawson pass over the real coordinates.
+ */
+class Lattice {
+public:
+    // node j * nx + i of every point, empty when the points are not on a grid
+    std::vector<uint32_t> nodes;
+    uint32_t nx {0}, ny {0};
+    double x0 {0}, y0 {0}, dx {0}, dy {0};
+    bool exact {false};                 // full grid of exact rectangles, triangulate is Delaunay as it is
+
+    // find the spacing and the node of every point; the input counts as a grid if every point lies
+    // within a hundredth of the spacing from a node, no two different positions share a node and at
+    // least half of the nodes are taken
+    bool detect(const std::vector<double>& coords);
+    void clear() { nodes.clear(); }
+    bool empty() const { return nodes.empty(); }
+
+    // triangulation of the points in mesh, false if a hole is too large to be filled by removals
+    bool triangulate(HalfEdgeMesh& mesh) const;
+
+private:
+    static constexpr uint32_t MAX_STAR = 32;  // largest star a missing node is removed from
+};
+
+
+#endif //DELAUNAY_LATTICE_H
@@ -0,0 +1,164 @@
+//
+// Created by lc06 on 5/2/2023.
+//
+
+#include "Lawson.h"
+
+#include <algorithm>
+#include <utility>
+
+// f(i) for every i in [0, count), in chunks so the pool is not fed one incircle test at a time
+template<typename F>
+static void forEach(ThreadPool& pool, size_t count, const F& f) {
+    pool.parallelRanges(count, 256, [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; ++i) f(i);
+    });
+}
+
+bool Lawson::illegal(uint32_t e) const {
+    const auto& triangles = mesh->triangles;
+    uint32_t f = mesh->halfedges[e];
+
+    uint32_t a = triangles[e], b = triangles[HalfEdgeMesh::next(e)], c = triangles[HalfEdgeMesh::prev(e)];
+    uint32_t d = triangles[HalfEdgeMesh::prev(f)];
+    return incirclePerturbed(point(a), point(b), point(c), point(d), arithmetic) > 0.;
+}
+
+void Lawson::flip(Flip& flip) {
+    auto& triangles = mesh->triangles;
+    auto& halfedges = mesh->halfedges;
+
+    /*
+     *      c                c
+     *     / \              /|\
+     *    a---b    ->      a | b
+     *     \ /              \|/
+     *      d                d
+     */
+    uint32_t e = flip.e, f = halfedges[e];
+    uint32_t a = triangles[e], b = triangles[HalfEdgeMesh::next(e)], c = triangles[HalfEdgeMesh::prev(e)];
+    uint32_t d = triangles[HalfEdgeMesh::prev(f)];
+
+    flip.outer[0] = halfedges[HalfEdgeMesh::prev(e)];
+    flip.outer[1] = halfedges[HalfEdgeMesh::next(f)];
+    flip.outer[2] = halfedges[HalfEdgeMesh::prev(f)];
+    flip.outer[3] = halfedges[HalfEdgeMesh::next(e)];
+
+    uint32_t t1 = flip.t1, t2 = flip.t2;
+    triangles[3 * t1] = c;
+    triangles[3 * t1 + 1] = a;
+    triangles[3 * t1 + 2] = d;
+    triangles[3 * t2] = d;
+    triangles[3 * t2 + 1] = b;
+    triangles[3 * t2 + 2] = c;
+
+    flipped[t1] = flipped[t2] = round;
+    partner[t1] = t2;
+    partner[t2] = t1;
+}
+
+uint32_t Lawson::find(uint32_t t, uint32_t from, uint32_t to) const {
+    const auto& triangles = mesh->triangles;
+    for(uint32_t u : {t, partner[t]})
+        for(uint32_t e = 3 * u; e < 3 * u + 3; ++e)
+            if(triangles[e] == from && triangles[HalfEdgeMesh::next(e)] == to) return e;
+
+    return HalfEdgeMesh::INVALID;
+}
+
+void Lawson::relink(const Flip& flip) {
+    auto& triangles = mesh->triangles;
+    auto& halfedges = mesh->halfedges;
+
+    // c->a, a->d in t1 and d->b, b->c in t2
+    uint32_t outer[4] = {3 * flip.t1, 3 * flip.t1 + 1, 3 * flip.t2, 3 * flip.t2 + 1};
+    for(int k = 0; k < 4; ++k) {
+        uint32_t h = outer[k], o = flip.outer[k];
+
+        // a twin flipped in the same round has moved inside its own pair, the others are relinked from here
+        if(o != HalfEdgeMesh::INVALID && flipped[o / 3] == round)
+            o = find(o / 3, triangles[HalfEdgeMesh::next(h)], triangles[h]);
+        else if(o != HalfEdgeMesh::INVALID)
+            halfedges[o] = h;
+        halfedges[h] = o;
+    }
+
+    halfedges[3 * flip.t1 + 2] = 3 * flip.t2 + 2;
+    halfedges[3 * flip.t2 + 2] = 3 * flip.t1 + 2;
+}
+
+size_t Lawson::legalize(std::vector<unsigned int> triangles, HalfEdgeMesh& _mesh, ThreadPool& pool) {
+    mesh = &_mesh;
+
+    size_t n = triangles.size() / 3;
+    std::vector<char> degenerate(n, 0);
+    for(size_t t = 0; t < n; ++t) {
+        double o = orient2d(point(triangles[3 * t]), point(triangles[3 * t + 1]), point(triangles[3 * t + 2]), arithmetic);
+        if(o < 0.) std::swap(triangles[3 * t + 1], triangles[3 * t + 2]);
+        else if(o == 0.) degenerate[t] = 1;
+    }
+    mesh->build(std::move(triangles));
+
+    flipped.assign(n, 0);
+    partner.assign(n, HalfEdgeMesh::INVALID);
+    round = 0;
+
+    // one half-edge per interior edge, the lower of the pair
+    std::vector<uint32_t> seen(3 * n, 0);
+    std::vector<uint32_t> candidates;
+    auto collect = [&](uint32_t t) {
+        for(uint32_t e = 3 * t; e < 3 * t + 3; ++e) {
+            uint32_t f = mesh->halfedges[e];
+            if(f == HalfEdgeMesh::INVALID || degenerate[e / 3] || degenerate[f / 3]) continue;
+
+            uint32_t lower = std::min(e, f);
+            if(seen[lower] == round) continue;
+            seen[lower] = round;
+            candidates.push_back(lower);
+        }
+    };
+
+    round = 1;
+    for(uint32_t t = 0; t < n; ++t) collect(t);
+
+    std::vector<char> verdicts;
+    std::vector<uint32_t> owner(n, HalfEdgeMesh::INVALID);
+    std::vector<uint32_t> dirty;
+    std::vector<Flip> flips;
+    size_t total = 0;
+
+    while(!candidates.empty()) {
+        verdicts.assign(candidates.size(), 0);
+        forEach(pool, candidates.size(), [&](size_t i) { verdicts[i] = illegal(candidates[i]); });
+
+        // the lowest illegal edge around a triangle owns it, a flip needs both of its triangles
+        for(size_t i = 0; i < candidates.size(); ++i) {
+            if(!verdicts[i]) continue;
+            uint32_t e = candidates[i];
+            for(uint32_t t : {e / 3, mesh->halfedges[e] / 3}) owner[t] = std::min(owner[t], e);
+        }
+
+        flips.clear();
+        dirty.clear();
+        for(size_t i = 0; i < candidates.size(); ++i) {
+            if(!verdicts[i]) continue;
+            uint32_t e = candidates[i], t1 = e / 3, t2 = mesh->halfedges[e] / 3;
+            if(owner[t1] == e && owner[t2] == e) flips.push_back({e, t1, t2, {}});
+
+            dirty.push_back(t1);
+            dirty.push_back(t2);
+        }
+        for(auto t : dirty) owner[t] = HalfEdgeMesh::INVALID;
+
+        forEach(pool, flips.size(), [&](size_t i) { flip(flips[i]); });
+        forEach(pool, flips.size(), [&](size_t i) { relink(flips[i]); });
+        total += flips.size();
+
+        // the outer edges of the flipped quads and the edges that lost the selection are tested again
+        round++;
+        candidates.clear();
+        for(auto t : dirty) collect(t);
+    }
+
+    return total;
+}
@@ -0,0 +1,58 @@
+//
+// Created by lc06 on 5/2/2023.
+//
+
+#ifndef DELAUNAY_LAWSON_H
+#define DELAUNAY_LAWSON_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "HalfEdgeMesh.h"
+#include "Predicates.h"
+#include "ThreadPool.h"
+
+/*
+ * Lawson edge-flip legalization of an existing triangulation.
+ *
+ * Every round tests the candidate edges on the pool, then flips a set of illegal edges that share no
+ * triangle: the lowest illegal edge around a triangle owns it, so the lowest illegal edge of the whole
+ * mesh always flips and the rounds terminate. Flips keep their triangle slots, only the twins of the four
+ * outer edges are relinked. The next round tests the edges of the triangles that were flipped or lost
+ * the selection, so a near-Delaunay mesh costs little more than one pass over its edges.
+ */
+class Lawson {
+public:
+    explicit Lawson(const std::vector<double>& _coords, Arithmetic _arithmetic = Arithmetic::Adaptive)
+        : coords(_coords), arithmetic(_arithmetic) {}
+
+    // orient the triangles counterclockwise, pair up their twins into mesh and flip until every interior
+    // edge is locally Delaunay; degenerate triangles and non-manifold edges are left alone. Returns the
+    // number of flips.
+    size_t legalize(std::vector<unsigned int> triangles, HalfEdgeMesh& mesh, ThreadPool& pool);
+
+private:
+    struct Flip {
+        uint32_t e;             // flipped half-edge, in t1
+        uint32_t t1, t2;
+        uint32_t outer[4];      // twins of c->a, a->d, d->b, b->c before the flip
+    };
+
+    const std::vector<double>& coords;
+    Arithmetic arithmetic;
+
+    HalfEdgeMesh* mesh {nullptr};
+    std::vector<uint32_t> flipped;      // round in which the triangle was last flipped
+    std::vector<uint32_t> partner;      // other triangle of that flip
+    uint32_t round {0};
+
+    const double* point(uint32_t v) const { return &coords[2 * v]; }
+    bool illegal(uint32_t e) const;
+    void flip(Flip& flip);
+    void relink(const Flip& flip);
+    uint32_t find(uint32_t t, uint32_t from, uint32_t to) const;
+};
+
+
+#endif //DELAUNAY_LAWSON_H
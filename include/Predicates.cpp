@@ -0,0 +1,446 @@
+//
+// Created by lc06 on 4/27/2023.
+//
+
+#include "Predicates.h"
+
+#include <utility>
+
+/*
+ * Adaptive stages of the predicates, on Shewchuk's nonoverlapping floating-point expansions.
+ *
+ * An expansion is a sum of doubles ordered by increasing magnitude whose sum is exact; zero
+ * components are dropped. The last component approximates the whole value and carries its sign.
+ * Every expansion lives in a stack array sized for its worst-case length, nothing is allocated.
+ *
+ * After the stage A filter in Predicates.h fails, stage B evaluates the determinant exactly from the
+ * rounded coordinate differences, which is already the exact result when those differences are exact
+ * (close points, grids). Stage C adds the first-order terms of the difference tails in doubles, and
+ * only when that is still too close to call does the exact evaluation from the raw coordinates run.
+ */
+
+namespace {
+    using predicates::epsilon;
+    constexpr double resultErrBound = (3.0 + 8.0 * epsilon) * epsilon;
+    constexpr double ccwErrBoundB = (2.0 + 12.0 * epsilon) * epsilon;
+    constexpr double ccwErrBoundC = (9.0 + 64.0 * epsilon) * epsilon * epsilon;
+    constexpr double iccErrBoundB = (4.0 + 48.0 * epsilon) * epsilon;
+    constexpr double iccErrBoundC = (44.0 + 576.0 * epsilon) * epsilon * epsilon;
+    constexpr double o3dErrBoundB = (3.0 + 28.0 * epsilon) * epsilon;
+    constexpr double o3dErrBoundC = (26.0 + 288.0 * epsilon) * epsilon * epsilon;
+    constexpr double ispErrBoundB = (5.0 + 72.0 * epsilon) * epsilon;
+    constexpr double ispErrBoundC = (71.0 + 1408.0 * epsilon) * epsilon * epsilon;
+
+    inline void fastTwoSum(double a, double b, double& x, double& y) {
+        x = a + b;
+        y = b - (x - a);
+    }
+
+    inline void twoSum(double a, double b, double& x, double& y) {
+        x = a + b;
+        double bVirtual = x - a;
+        double aVirtual = x - bVirtual;
+        y = (a - aVirtual) + (b - bVirtual);
+    }
+
+    inline void twoDiff(double a, double b, double& x, double& y) {
+        x = a - b;
+        double bVirtual = a - x;
+        double aVirtual = x + bVirtual;
+        y = (a - aVirtual) + (bVirtual - b);
+    }
+
+    // the rounding error of x = a - b
+    inline double twoDiffTail(double a, double b, double x) {
+        double bVirtual = a - x;
+        double aVirtual = x + bVirtual;
+        return (a - aVirtual) + (bVirtual - b);
+    }
+
+    inline void twoProduct(double a, double b, double& x, double& y) {
+        x = a * b;
+        y = std::fma(a, b, -x);
+    }
+
+    inline void twoOneDiff(double a1, double a0, double b, double& x2, double& x1, double& x0) {
+        double i;
+        twoDiff(a0, b, i, x0);
+        twoSum(a1, i, x2, x1);
+    }
+
+    // (a1 + a0) - (b1 + b0) as four components
+    inline void twoTwoDiff(double a1, double a0, double b1, double b0, double* x) {
+        double j, k;
+        twoOneDiff(a1, a0, b0, j, k, x[0]);
+        twoOneDiff(j, k, b1, x[3], x[2], x[1]);
+    }
+
+    // a * d - b * c as four components
+    inline void cross(double a, double d, double b, double c, double* x) {
+        double ad1, ad0, bc1, bc0;
+        twoProduct(a, d, ad1, ad0);
+        twoProduct(b, c, bc1, bc0);
+        twoTwoDiff(ad1, ad0, bc1, bc0, x);
+    }
+
+    // h = e + f, fast_expansion_sum_zeroelim; h has room for eLength + fLength components
+    int sum(int eLength, const double* e, int fLength, const double* f, double* h) {
+        int i = 0, j = 0, k = 0;
+        double q, qNew, hh;
+        if((f[0] > e[0]) == (f[0] > -e[0])) q = e[i++];
+        else q = f[j++];
+
+        if(i < eLength && j < fLength) {
+            if((f[j] > e[i]) == (f[j] > -e[i])) fastTwoSum(e[i++], q, qNew, hh);
+            else fastTwoSum(f[j++], q, qNew, hh);
+            q = qNew;
+            if(hh != 0.) h[k++] = hh;
+
+            while(i < eLength && j < fLength) {
+                if((f[j] > e[i]) == (f[j] > -e[i])) twoSum(q, e[i++], qNew, hh);
+                else twoSum(q, f[j++], qNew, hh);
+                q = qNew;
+                if(hh != 0.) h[k++] = hh;
+            }
+        }
+        while(i < eLength) {
+            twoSum(q, e[i++], qNew, hh);
+            q = qNew;
+            if(hh != 0.) h[k++] = hh;
+        }
+        while(j < fLength) {
+            twoSum(q, f[j++], qNew, hh);
+            q = qNew;
+            if(hh != 0.) h[k++] = hh;
+        }
+        if(q != 0. || k == 0) h[k++] = q;
+        return k;
+    }
+
+    // h = e * b, scale_expansion_zeroelim; h has room for 2 * eLength components
+    int scale(int eLength, const double* e, double b, double* h) {
+        double q, hh, product1, product0, s;
+        int k = 0;
+        twoProduct(e[0], b, q, hh);
+        if(hh != 0.) h[k++] = hh;
+        for(int i = 1; i < eLength; ++i) {
+            twoProduct(e[i], b, product1, product0);
+            twoSum(q, product0, s, hh);
+            if(hh != 0.) h[k++] = hh;
+            fastTwoSum(product1, s, q, hh);
+            if(hh != 0.) h[k++] = hh;
+        }
+        if(q != 0. || k == 0) h[k++] = q;
+        return k;
+    }
+
+    void negate(int eLength, double* e) {
+        for(int i = 0; i < eLength; ++i) e[i] = -e[i];
+    }
+
+    double estimate(int eLength, const double* e) {
+        double q = e[0];
+        for(int i = 1; i < eLength; ++i) q += e[i];
+        return q;
+    }
+
+    // h = (x^2 + y^2) e for an e of at most N components, h has room for 8N
+    template<int N>
+    int lift(int eLength, const double* e, double x, double y, double* h) {
+        double ex[2 * N], exx[4 * N], ey[2 * N], eyy[4 * N];
+        int exxLength = scale(scale(eLength, e, x, ex), ex, x, exx);
+        int eyyLength = scale(scale(eLength, e, y, ey), ey, y, eyy);
+        return sum(exxLength, exx, eyyLength, eyy, h);
+    }
+
+    // h = (x^2 + y^2 + z^2) e for an e of at most N components, h has room for 12N
+    template<int N>
+    int lift(int eLength, const double* e, double x, double y, double z, double* h) {
+        double xy[8 * N], ez[2 * N], ezz[4 * N];
+        int xyLength = lift<N>(eLength, e, x, y, xy);
+        int ezzLength = scale(scale(eLength, e, z, ez), ez, z, ezz);
+        return sum(xyLength, xy, ezzLength, ezz, h);
+    }
+
+    // 2x2 minors of the raw x / y of n points, minors[i][j] = xi yj - xj yi for i < j
+    void minors(const double* const* p, int n, double (*m)[5][4]) {
+        for(int i = 0; i < n; ++i)
+            for(int j = i + 1; j < n; ++j) cross(p[i][0], p[j][1], p[j][0], p[i][1], m[i][j]);
+    }
+
+    // det[[xi, yi, 1], [xj, yj, 1], [xk, yk, 1]] = ij + jk - ik for i < j < k, at most 12 components
+    int triangle(double (*m)[5][4], int i, int j, int k, double* h) {
+        double ik[4], ijjk[8];
+        for(int c = 0; c < 4; ++c) ik[c] = -m[i][k][c];
+        int length = sum(4, m[i][j], 4, m[j][k], ijjk);
+        return sum(length, ijjk, 4, ik, h);
+    }
+
+    // h = e1 * b1 + e2 * b2 + e3 * b3 for three 4-component e, at most 24 components
+    int combine(const double* e1, double b1, const double* e2, double b2, const double* e3, double b3, double* h) {
+        double t1[8], t2[8], t3[8], t12[16];
+        int length1 = scale(4, e1, b1, t1);
+        int length2 = scale(4, e2, b2, t2);
+        int length3 = scale(4, e3, b3, t3);
+        int length12 = sum(length1, t1, length2, t2, t12);
+        return sum(length12, t12, length3, t3, h);
+    }
+
+    // det[[x, y, z, 1]] of the points i < j < k < l, expanded along z, at most 96 components
+    int tetrahedron(const double* const* p, double (*m)[5][4], int i, int j, int k, int l, double* h) {
+        const int rows[4] = {i, j, k, l};
+        double terms[4][24];
+        int lengths[4];
+        for(int r = 0; r < 4; ++r) {
+            int others[3], o = 0;
+            for(int s = 0; s < 4; ++s)
+                if(s != r) others[o++] = rows[s];
+
+            double t[12];
+            int length = triangle(m, others[0], others[1], others[2], t);
+            lengths[r] = scale(length, t, r % 2 == 0 ? p[rows[r]][2] : -p[rows[r]][2], terms[r]);
+        }
+
+        double ij[48], kl[48];
+        int ijLength = sum(lengths[0], terms[0], lengths[1], terms[1], ij);
+        int klLength = sum(lengths[2], terms[2], lengths[3], terms[3], kl);
+        return sum(ijLength, ij, klLength, kl, h);
+    }
+}
+
+double predicates::orient2dAdapt(const double* pa, const double* pb, const double* pc, double detSum) {
+    double acx = pa[0] - pc[0], bcx = pb[0] - pc[0];
+    double acy = pa[1] - pc[1], bcy = pb[1] - pc[1];
+
+    double b[4];
+    cross(acx, bcy, acy, bcx, b);
+    double det = estimate(4, b);
+    double errBound = ccwErrBoundB * detSum;
+    if(det >= errBound || -det >= errBound) return det;
+
+    double acxTail = twoDiffTail(pa[0], pc[0], acx), bcxTail = twoDiffTail(pb[0], pc[0], bcx);
+    double acyTail = twoDiffTail(pa[1], pc[1], acy), bcyTail = twoDiffTail(pb[1], pc[1], bcy);
+    if(acxTail == 0. && acyTail == 0. && bcxTail == 0. && bcyTail == 0.) return det;
+
+    errBound = ccwErrBoundC * detSum + resultErrBound * std::fabs(det);
+    det += (acx * bcyTail + bcy * acxTail) - (acy * bcxTail + bcx * acyTail);
+    if(det >= errBound || -det >= errBound) return det;
+
+    // the products with the tails, added exactly
+    double u[4], c1[8], c2[12], d[16];
+    cross(acxTail, bcy, acyTail, bcx, u);
+    int c1Length = sum(4, b, 4, u, c1);
+    cross(acx, bcyTail, acy, bcxTail, u);
+    int c2Length = sum(c1Length, c1, 4, u, c2);
+    cross(acxTail, bcyTail, acyTail, bcxTail, u);
+    int dLength = sum(c2Length, c2, 4, u, d);
+    return d[dLength - 1];
+}
+
+double predicates::incircleAdapt(const double* pa, const double* pb, const double* pc, const double* pd, double permanent) {
+    double adx = pa[0] - pd[0], ady = pa[1] - pd[1];
+    double bdx = pb[0] - pd[0], bdy = pb[1] - pd[1];
+    double cdx = pc[0] - pd[0], cdy = pc[1] - pd[1];
+
+    double bc[4], ca[4], ab[4];
+    cross(bdx, cdy, cdx, bdy, bc);
+    cross(cdx, ady, adx, cdy, ca);
+    cross(adx, bdy, bdx, ady, ab);
+
+    double adet[32], bdet[32], cdet[32], abdet[64], fin[96];
+    int aLength = lift<4>(4, bc, adx, ady, adet);
+    int bLength = lift<4>(4, ca, bdx, bdy, bdet);
+    int cLength = lift<4>(4, ab, cdx, cdy, cdet);
+    int abLength = sum(aLength, adet, bLength, bdet, abdet);
+    int finLength = sum(abLength, abdet, cLength, cdet, fin);
+
+    double det = estimate(finLength, fin);
+    double errBound = iccErrBoundB * permanent;
+    if(det >= errBound || -det >= errBound) return det;
+
+    double adxTail = twoDiffTail(pa[0], pd[0], adx), adyTail = twoDiffTail(pa[1], pd[1], ady);
+    double bdxTail = twoDiffTail(pb[0], pd[0], bdx), bdyTail = twoDiffTail(pb[1], pd[1], bdy);
+    double cdxTail = twoDiffTail(pc[0], pd[0], cdx), cdyTail = twoDiffTail(pc[1], pd[1], cdy);
+    if(adxTail == 0. && bdxTail == 0. && cdxTail == 0. && adyTail == 0. && bdyTail == 0. && cdyTail == 0.) return det;
+
+    errBound = iccErrBoundC * permanent + resultErrBound * std::fabs(det);
+    det += ((adx * adx + ady * ady) * ((bdx * cdyTail + cdy * bdxTail) - (bdy * cdxTail + cdx * bdyTail))
+            + 2. * (adx * adxTail + ady * adyTail) * (bdx * cdy - bdy * cdx))
+         + ((bdx * bdx + bdy * bdy) * ((cdx * adyTail + ady * cdxTail) - (cdy * adxTail + adx * cdyTail))
+            + 2. * (bdx * bdxTail + bdy * bdyTail) * (cdx * ady - cdy * adx))
+         + ((cdx * cdx + cdy * cdy) * ((adx * bdyTail + bdy * adxTail) - (ady * bdxTail + bdx * adyTail))
+            + 2. * (cdx * cdxTail + cdy * cdyTail) * (adx * bdy - ady * bdx));
+    if(det >= errBound || -det >= errBound) return det;
+
+    return incircleExact(pa, pb, pc, pd);
+}
+
+double predicates::orient3dAdapt(const double* pa, const double* pb, const double* pc, const double* pd, double permanent) {
+    double adx = pa[0] - pd[0], ady = pa[1] - pd[1], adz = pa[2] - pd[2];
+    double bdx = pb[0] - pd[0], bdy = pb[1] - pd[1], bdz = pb[2] - pd[2];
+    double cdx = pc[0] - pd[0], cdy = pc[1] - pd[1], cdz = pc[2] - pd[2];
+
+    double bc[4], ca[4], ab[4];
+    cross(bdx, cdy, cdx, bdy, bc);
+    cross(cdx, ady, adx, cdy, ca);
+    cross(adx, bdy, bdx, ady, ab);
+
+    double fin[24];
+    int finLength = combine(bc, adz, ca, bdz, ab, cdz, fin);
+
+    double det = estimate(finLength, fin);
+    double errBound = o3dErrBoundB * permanent;
+    if(det >= errBound || -det >= errBound) return det;
+
+    double adxTail = twoDiffTail(pa[0], pd[0], adx), adyTail = twoDiffTail(pa[1], pd[1], ady), adzTail = twoDiffTail(pa[2], pd[2], adz);
+    double bdxTail = twoDiffTail(pb[0], pd[0], bdx), bdyTail = twoDiffTail(pb[1], pd[1], bdy), bdzTail = twoDiffTail(pb[2], pd[2], bdz);
+    double cdxTail = twoDiffTail(pc[0], pd[0], cdx), cdyTail = twoDiffTail(pc[1], pd[1], cdy), cdzTail = twoDiffTail(pc[2], pd[2], cdz);
+    if(adxTail == 0. && bdxTail == 0. && cdxTail == 0. && adyTail == 0. && bdyTail == 0. && cdyTail == 0.
+       && adzTail == 0. && bdzTail == 0. && cdzTail == 0.) return det;
+
+    errBound = o3dErrBoundC * permanent + resultErrBound * std::fabs(det);
+    det += (adz * ((bdx * cdyTail + cdy * bdxTail) - (bdy * cdxTail + cdx * bdyTail)) + adzTail * (bdx * cdy - bdy * cdx))
+         + (bdz * ((cdx * adyTail + ady * cdxTail) - (cdy * adxTail + adx * cdyTail)) + bdzTail * (cdx * ady - cdy * adx))
+         + (cdz * ((adx * bdyTail + bdy * adxTail) - (ady * bdxTail + bdx * adyTail)) + cdzTail * (adx * bdy - ady * bdx));
+    if(det >= errBound || -det >= errBound) return det;
+
+    return orient3dExact(pa, pb, pc, pd);
+}
+
+double predicates::insphereAdapt(const double* pa, const double* pb, const double* pc, const double* pd, const double* pe,
+                                 double permanent) {
+    double aex = pa[0] - pe[0], aey = pa[1] - pe[1], aez = pa[2] - pe[2];
+    double bex = pb[0] - pe[0], bey = pb[1] - pe[1], bez = pb[2] - pe[2];
+    double cex = pc[0] - pe[0], cey = pc[1] - pe[1], cez = pc[2] - pe[2];
+    double dex = pd[0] - pe[0], dey = pd[1] - pe[1], dez = pd[2] - pe[2];
+
+    double ab[4], bc[4], cd[4], da[4], ac[4], bd[4];
+    cross(aex, bey, bex, aey, ab);
+    cross(bex, cey, cex, bey, bc);
+    cross(cex, dey, dex, cey, cd);
+    cross(dex, aey, aex, dey, da);
+    cross(aex, cey, cex, aey, ac);
+    cross(bex, dey, dex, bey, bd);
+
+    // the 3x3 minors abc, bcd, cda, dab, each times the lift of the fourth point
+    double minor[24], adet[288], bdet[288], cdet[288], ddet[288];
+    int length = combine(cd, bez, bd, -cez, bc, dez, minor);
+    negate(length, minor);
+    int aLength = lift<24>(length, minor, aex, aey, aez, adet);
+    length = combine(da, cez, ac, dez, cd, aez, minor);
+    int bLength = lift<24>(length, minor, bex, bey, bez, bdet);
+    length = combine(ab, dez, bd, aez, da, bez, minor);
+    negate(length, minor);
+    int cLength = lift<24>(length, minor, cex, cey, cez, cdet);
+    length = combine(bc, aez, ac, -bez, ab, cez, minor);
+    int dLength = lift<24>(length, minor, dex, dey, dez, ddet);
+
+    double abdet[576], cddet[576], fin[1152];
+    int abLength = sum(aLength, adet, bLength, bdet, abdet);
+    int cdLength = sum(cLength, cdet, dLength, ddet, cddet);
+    int finLength = sum(abLength, abdet, cdLength, cddet, fin);
+
+    double det = estimate(finLength, fin);
+    double errBound = ispErrBoundB * permanent;
+    if(det >= errBound || -det >= errBound) return det;
+
+    double aexTail = twoDiffTail(pa[0], pe[0], aex), aeyTail = twoDiffTail(pa[1], pe[1], aey), aezTail = twoDiffTail(pa[2], pe[2], aez);
+    double bexTail = twoDiffTail(pb[0], pe[0], bex), beyTail = twoDiffTail(pb[1], pe[1], bey), bezTail = twoDiffTail(pb[2], pe[2], bez);
+    double cexTail = twoDiffTail(pc[0], pe[0], cex), ceyTail = twoDiffTail(pc[1], pe[1], cey), cezTail = twoDiffTail(pc[2], pe[2], cez);
+    double dexTail = twoDiffTail(pd[0], pe[0], dex), deyTail = twoDiffTail(pd[1], pe[1], dey), dezTail = twoDiffTail(pd[2], pe[2], dez);
+    if(aexTail == 0. && aeyTail == 0. && aezTail == 0. && bexTail == 0. && beyTail == 0. && bezTail == 0.
+       && cexTail == 0. && ceyTail == 0. && cezTail == 0. && dexTail == 0. && deyTail == 0. && dezTail == 0.) return det;
+
+    // first-order corrections of the 2x2 minors, whose rounded values are the top components
+    errBound = ispErrBoundC * permanent + resultErrBound * std::fabs(det);
+    double abEps = (aex * beyTail + bey * aexTail) - (aey * bexTail + bex * aeyTail);
+    double bcEps = (bex * ceyTail + cey * bexTail) - (bey * cexTail + cex * beyTail);
+    double cdEps = (cex * deyTail + dey * cexTail) - (cey * dexTail + dex * ceyTail);
+    double daEps = (dex * aeyTail + aey * dexTail) - (dey * aexTail + aex * deyTail);
+    double acEps = (aex * ceyTail + cey * aexTail) - (aey * cexTail + cex * aeyTail);
+    double bdEps = (bex * deyTail + dey * bexTail) - (bey * dexTail + dex * beyTail);
+    det += (((bex * bex + bey * bey + bez * bez)
+             * ((cez * daEps + dez * acEps + aez * cdEps) + (cezTail * da[3] + dezTail * ac[3] + aezTail * cd[3]))
+             + (dex * dex + dey * dey + dez * dez)
+             * ((aez * bcEps - bez * acEps + cez * abEps) + (aezTail * bc[3] - bezTail * ac[3] + cezTail * ab[3])))
+            - ((aex * aex + aey * aey + aez * aez)
+             * ((bez * cdEps - cez * bdEps + dez * bcEps) + (bezTail * cd[3] - cezTail * bd[3] + dezTail * bc[3]))
+             + (cex * cex + cey * cey + cez * cez)
+             * ((dez * abEps + aez * bdEps + bez * daEps) + (dezTail * ab[3] + aezTail * bd[3] + bezTail * da[3]))))
+         + 2. * (((bex * bexTail + bey * beyTail + bez * bezTail) * (cez * da[3] + dez * ac[3] + aez * cd[3])
+                  + (dex * dexTail + dey * deyTail + dez * dezTail) * (aez * bc[3] - bez * ac[3] + cez * ab[3]))
+                 - ((aex * aexTail + aey * aeyTail + aez * aezTail) * (bez * cd[3] - cez * bd[3] + dez * bc[3])
+                    + (cex * cexTail + cey * ceyTail + cez * cezTail) * (dez * ab[3] + aez * bd[3] + bez * da[3])));
+    if(det >= errBound || -det >= errBound) return det;
+
+    return insphereExact(pa, pb, pc, pd, pe);
+}
+
+// det[[x, y, x^2 + y^2, 1]] of a, b, c, d, expanded along the lifts
+double predicates::incircleExact(const double* pa, const double* pb, const double* pc, const double* pd) {
+    const double* p[4] = {pa, pb, pc, pd};
+    double m[5][5][4];
+    minors(p, 4, m);
+
+    double terms[4][96];
+    int lengths[4];
+    for(int r = 0; r < 4; ++r) {
+        int others[3], o = 0;
+        for(int s = 0; s < 4; ++s)
+            if(s != r) others[o++] = s;
+
+        double t[12];
+        int length = triangle(m, others[0], others[1], others[2], t);
+        if(r % 2 == 1) negate(length, t);
+        lengths[r] = lift<12>(length, t, p[r][0], p[r][1], terms[r]);
+    }
+
+    double ab[192], cd[192], det[384];
+    int abLength = sum(lengths[0], terms[0], lengths[1], terms[1], ab);
+    int cdLength = sum(lengths[2], terms[2], lengths[3], terms[3], cd);
+    int length = sum(abLength, ab, cdLength, cd, det);
+    return det[length - 1];
+}
+
+// det[[x, y, z, 1]] of a, b, c, d
+double predicates::orient3dExact(const double* pa, const double* pb, const double* pc, const double* pd) {
+    const double* p[4] = {pa, pb, pc, pd};
+    double m[5][5][4];
+    minors(p, 4, m);
+
+    double det[96];
+    int length = tetrahedron(p, m, 0, 1, 2, 3, det);
+    return det[length - 1];
+}
+
+// det[[x, y, z, x^2 + y^2 + z^2, 1]] of a, b, c, d, e, expanded along the lifts
+double predicates::insphereExact(const double* pa, const double* pb, const double* pc, const double* pd, const double* pe) {
+    const double* p[5] = {pa, pb, pc, pd, pe};
+    double m[5][5][4];
+    minors(p, 5, m);
+
+    // the sum grows term by term, ping-ponging between two buffers
+    double term[1152], first[5760], second[5760];
+    double* det = first;
+    double* next = second;
+    int length = 0;
+    for(int r = 0; r < 5; ++r) {
+        int others[4], o = 0;
+        for(int s = 0; s < 5; ++s)
+            if(s != r) others[o++] = s;
+
+        double t[96];
+        int tLength = tetrahedron(p, m, others[0], others[1], others[2], others[3], t);
+        if(r % 2 == 0) negate(tLength, t);
+        int termLength = lift<96>(tLength, t, p[r][0], p[r][1], p[r][2], term);
+
+        if(length == 0) {
+            for(int i = 0; i < termLength; ++i) det[i] = term[i];
+            length = termLength;
+            continue;
+        }
+        length = sum(length, det, termLength, term, next);
+        std::swap(det, next);
+    }
+    return det[length - 1];
+}
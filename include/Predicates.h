@@ -0,0 +1,245 @@
+//
+// Created by lc06 on 4/18/2023.
+//
+
+#ifndef DELAUNAY_PREDICATES_H
+#define DELAUNAY_PREDICATES_H
+
+#include <cmath>
+#include <cstdint>
+
+/*
+ * Adaptive geometric predicates in the calling convention of Shewchuk's predicates.c
+ *
+ * orient2d(pa, pb, pc)     > 0 if pa, pb, pc are in counterclockwise order
+ * incircle(pa, pb, pc, pd) > 0 if pd lies inside the circle through the counterclockwise pa, pb, pc
+ * orient3d(pa, pb, pc, pd) > 0 if pd lies below the plane of pa, pb, pc, counterclockwise seen from above
+ * insphere(pa, pb, pc, pd, pe) > 0 if pe lies inside the sphere through pa, pb, pc, pd, orient3d of which is > 0
+ *
+ * The determinant is evaluated in plain doubles first and accepted when it exceeds an error bound
+ * scaled by the magnitude of its terms (Shewchuk's stage A filter). Only near-degenerate inputs fall
+ * through to the adaptive stages in Predicates.cpp, which refine the estimate until its sign is
+ * certain, so the sign is always correct.
+ */
+
+namespace predicates {
+    constexpr double epsilon = 1.1102230246251565e-16;      // 2^-53
+    constexpr double ccwErrBound = (3.0 + 16.0 * epsilon) * epsilon;
+    constexpr double iccErrBound = (10.0 + 96.0 * epsilon) * epsilon;
+    constexpr double o3dErrBound = (7.0 + 56.0 * epsilon) * epsilon;
+    constexpr double ispErrBound = (16.0 + 224.0 * epsilon) * epsilon;
+
+    double orient2dAdapt(const double* pa, const double* pb, const double* pc, double detSum);
+    double incircleAdapt(const double* pa, const double* pb, const double* pc, const double* pd, double permanent);
+    double orient3dAdapt(const double* pa, const double* pb, const double* pc, const double* pd, double permanent);
+    double insphereAdapt(const double* pa, const double* pb, const double* pc, const double* pd, const double* pe, double permanent);
+    double incircleExact(const double* pa, const double* pb, const double* pc, const double* pd);
+    double orient3dExact(const double* pa, const double* pb, const double* pc, const double* pd);
+    double insphereExact(const double* pa, const double* pb, const double* pc, const double* pd, const double* pe);
+}
+
+inline double orient2d(const double* pa, const double* pb, const double* pc) {
+    double detLeft = (pa[0] - pc[0]) * (pb[1] - pc[1]);
+    double detRight = (pa[1] - pc[1]) * (pb[0] - pc[0]);
+    double det = detLeft - detRight;
+
+    double detSum;
+    if(detLeft > 0.) {
+        if(detRight <= 0.) return det;
+        detSum = detLeft + detRight;
+    }
+    else if(detLeft < 0.) {
+        if(detRight >= 0.) return det;
+        detSum = -detLeft - detRight;
+    }
+    else return det;
+
+    if(det >= predicates::ccwErrBound * detSum || -det >= predicates::ccwErrBound * detSum) return det;
+    return predicates::orient2dAdapt(pa, pb, pc, detSum);
+}
+
+inline double incircle(const double* pa, const double* pb, const double* pc, const double* pd) {
+    double adx = pa[0] - pd[0], ady = pa[1] - pd[1];
+    double bdx = pb[0] - pd[0], bdy = pb[1] - pd[1];
+    double cdx = pc[0] - pd[0], cdy = pc[1] - pd[1];
+
+    double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+    double cdxady = cdx * ady, adxcdy = adx * cdy;
+    double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+    double alift = adx * adx + ady * ady;
+    double blift = bdx * bdx + bdy * bdy;
+    double clift = cdx * cdx + cdy * cdy;
+
+    double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+
+    double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * alift
+                     + (std::fabs(cdxady) + std::fabs(adxcdy)) * blift
+                     + (std::fabs(adxbdy) + std::fabs(bdxady)) * clift;
+
+    double errBound = predicates::iccErrBound * permanent;
+    if(det > errBound || -det > errBound) return det;
+    return predicates::incircleAdapt(pa, pb, pc, pd, permanent);
+}
+
+inline double orient3d(const double* pa, const double* pb, const double* pc, const double* pd) {
+    double adx = pa[0] - pd[0], ady = pa[1] - pd[1], adz = pa[2] - pd[2];
+    double bdx = pb[0] - pd[0], bdy = pb[1] - pd[1], bdz = pb[2] - pd[2];
+    double cdx = pc[0] - pd[0], cdy = pc[1] - pd[1], cdz = pc[2] - pd[2];
+
+    double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+    double cdxady = cdx * ady, adxcdy = adx * cdy;
+    double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+    double det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+
+    double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * std::fabs(adz)
+                     + (std::fabs(cdxady) + std::fabs(adxcdy)) * std::fabs(bdz)
+                     + (std::fabs(adxbdy) + std::fabs(bdxady)) * std::fabs(cdz);
+
+    double errBound = predicates::o3dErrBound * permanent;
+    if(det > errBound || -det > errBound) return det;
+    return predicates::orient3dAdapt(pa, pb, pc, pd, permanent);
+}
+
+inline double insphere(const double* pa, const double* pb, const double* pc, const double* pd, const double* pe) {
+    double aex = pa[0] - pe[0], aey = pa[1] - pe[1], aez = pa[2] - pe[2];
+    double bex = pb[0] - pe[0], bey = pb[1] - pe[1], bez = pb[2] - pe[2];
+    double cex = pc[0] - pe[0], cey = pc[1] - pe[1], cez = pc[2] - pe[2];
+    double dex = pd[0] - pe[0], dey = pd[1] - pe[1], dez = pd[2] - pe[2];
+
+    double aexbey = aex * bey, bexaey = bex * aey;
+    double bexcey = bex * cey, cexbey = cex * bey;
+    double cexdey = cex * dey, dexcey = dex * cey;
+    double dexaey = dex * aey, aexdey = aex * dey;
+    double aexcey = aex * cey, cexaey = cex * aey;
+    double bexdey = bex * dey, dexbey = dex * bey;
+
+    double ab = aexbey - bexaey, bc = bexcey - cexbey, cd = cexdey - dexcey;
+    double da = dexaey - aexdey, ac = aexcey - cexaey, bd = bexdey - dexbey;
+
+    double abc = aez * bc - bez * ac + cez * ab;
+    double bcd = bez * cd - cez * bd + dez * bc;
+    double cda = cez * da + dez * ac + aez * cd;
+    double dab = dez * ab + aez * bd + bez * da;
+
+    double alift = aex * aex + aey * aey + aez * aez;
+    double blift = bex * bex + bey * bey + bez * bez;
+    double clift = cex * cex + cey * cey + cez * cez;
+    double dlift = dex * dex + dey * dey + dez * dez;
+
+    double det = (dlift * abc - clift * dab) + (blift * cda - alift * bcd);
+
+    double abPlus = std::fabs(aexbey) + std::fabs(bexaey), bcPlus = std::fabs(bexcey) + std::fabs(cexbey);
+    double cdPlus = std::fabs(cexdey) + std::fabs(dexcey), daPlus = std::fabs(dexaey) + std::fabs(aexdey);
+    double acPlus = std::fabs(aexcey) + std::fabs(cexaey), bdPlus = std::fabs(bexdey) + std::fabs(dexbey);
+    double permanent = (std::fabs(aez) * bcPlus + std::fabs(bez) * acPlus + std::fabs(cez) * abPlus) * dlift
+                     + (std::fabs(bez) * cdPlus + std::fabs(cez) * bdPlus + std::fabs(dez) * bcPlus) * alift
+                     + (std::fabs(cez) * daPlus + std::fabs(dez) * acPlus + std::fabs(aez) * cdPlus) * blift
+                     + (std::fabs(dez) * abPlus + std::fabs(aez) * bdPlus + std::fabs(bez) * daPlus) * clift;
+
+    double errBound = predicates::ispErrBound * permanent;
+    if(det > errBound || -det > errBound) return det;
+    return predicates::insphereAdapt(pa, pb, pc, pd, pe, permanent);
+}
+
+/*
+ * Exact predicates for coordinates snapped to an integer grid, stored in doubles with magnitude below
+ * SNAP_LIMIT = 2^28. Differences then fit 29 bits: orient2d is exact in int64, incircle in 128-bit
+ * integers (lifts < 2^59, terms < 2^120), with no filter and no fallback. Compilers without __int128
+ * take the adaptive incircle, which is exact as well.
+ */
+constexpr double SNAP_LIMIT = 268435456.;
+
+inline double orient2dSnapped(const double* pa, const double* pb, const double* pc) {
+    int64_t acx = (int64_t)pa[0] - (int64_t)pc[0], acy = (int64_t)pa[1] - (int64_t)pc[1];
+    int64_t bcx = (int64_t)pb[0] - (int64_t)pc[0], bcy = (int64_t)pb[1] - (int64_t)pc[1];
+
+    int64_t det = acx * bcy - acy * bcx;
+    return (double)((det > 0) - (det < 0));
+}
+
+inline double incircleSnapped(const double* pa, const double* pb, const double* pc, const double* pd) {
+#ifdef __SIZEOF_INT128__
+    int64_t adx = (int64_t)pa[0] - (int64_t)pd[0], ady = (int64_t)pa[1] - (int64_t)pd[1];
+    int64_t bdx = (int64_t)pb[0] - (int64_t)pd[0], bdy = (int64_t)pb[1] - (int64_t)pd[1];
+    int64_t cdx = (int64_t)pc[0] - (int64_t)pd[0], cdy = (int64_t)pc[1] - (int64_t)pd[1];
+
+    __int128 alift = adx * adx + ady * ady;
+    __int128 blift = bdx * bdx + bdy * bdy;
+    __int128 clift = cdx * cdx + cdy * cdy;
+
+    __int128 det = alift * (bdx * cdy - cdx * bdy) + blift * (cdx * ady - adx * cdy) + clift * (adx * bdy - bdx * ady);
+    return (double)((det > 0) - (det < 0));
+#else
+    return incircle(pa, pb, pc, pd);
+#endif
+}
+
+// which of the two predicate families an engine evaluates
+enum class Arithmetic {
+    Adaptive,       // any double coordinates, floating-point filter with exact fallback
+    Snapped         // integer coordinates below SNAP_LIMIT, integer arithmetic only
+};
+
+/*
+ * The two families as compile-time predicate policies. An engine templated on its kernel calls
+ * K::orient2d / K::incircle directly instead of branching on an Arithmetic per test; Delaunay picks the
+ * kernel once per run, from the coordinates it hands over.
+ */
+struct AdaptiveKernel {
+    static constexpr Arithmetic arithmetic = Arithmetic::Adaptive;
+    static double orient2d(const double* pa, const double* pb, const double* pc) { return ::orient2d(pa, pb, pc); }
+    static double incircle(const double* pa, const double* pb, const double* pc, const double* pd) { return ::incircle(pa, pb, pc, pd); }
+};
+
+struct SnappedKernel {
+    static constexpr Arithmetic arithmetic = Arithmetic::Snapped;
+    static double orient2d(const double* pa, const double* pb, const double* pc) { return orient2dSnapped(pa, pb, pc); }
+    static double incircle(const double* pa, const double* pb, const double* pc, const double* pd) { return incircleSnapped(pa, pb, pc, pd); }
+};
+
+inline double orient2d(const double* pa, const double* pb, const double* pc, Arithmetic arithmetic) {
+    return arithmetic == Arithmetic::Snapped ? orient2dSnapped(pa, pb, pc) : orient2d(pa, pb, pc);
+}
+
+inline double incircle(const double* pa, const double* pb, const double* pc, const double* pd, Arithmetic arithmetic) {
+    return arithmetic == Arithmetic::Snapped ? incircleSnapped(pa, pb, pc, pd) : incircle(pa, pb, pc, pd);
+}
+
+/*
+ * incircle with the symbolic perturbation of Devillers and Teillaud (as in CGAL): pa, pb, pc must be
+ * counterclockwise and pd distinct from all three. Points exactly on the circle are decided by the
+ * orientations of the lexicographically largest points, so the result is never 0 and the perturbed
+ * Delaunay triangulation is unique even when many points are cocircular.
+ */
+template<typename K>
+inline double incirclePerturbed(const double* pa, const double* pb, const double* pc, const double* pd) {
+    double det = K::incircle(pa, pb, pc, pd);
+    if(det != 0.) return det;
+
+    const double* sorted[4] = {pa, pb, pc, pd};
+    for(int i = 1; i < 4; ++i)
+        for(int k = i; k > 0 && (sorted[k][0] < sorted[k - 1][0] || (sorted[k][0] == sorted[k - 1][0] && sorted[k][1] < sorted[k - 1][1])); --k) {
+            const double* swap = sorted[k];
+            sorted[k] = sorted[k - 1];
+            sorted[k - 1] = swap;
+        }
+
+    for(int i = 3; i > 1; --i) {
+        if(sorted[i] == pd) return -1.;
+
+        double o = 0.;
+        if(sorted[i] == pc) o = K::orient2d(pa, pb, pd);
+        else if(sorted[i] == pb) o = K::orient2d(pa, pd, pc);
+        else o = K::orient2d(pd, pb, pc);
+        if(o != 0.) return o;
+    }
+    return -1.;
+}
+
+inline double incirclePerturbed(const double* pa, const double* pb, const double* pc, const double* pd, Arithmetic arithmetic) {
+    return arithmetic == Arithmetic::Snapped ? incirclePerturbed<SnappedKernel>(pa, pb, pc, pd) : incirclePerturbed<AdaptiveKernel>(pa, pb, pc, pd);
+}
+
+#endif //DELAUNAY_PREDICATES_H
@@ -0,0 +1,81 @@
+//
+// Created by lc06 on 4/19/2023.
+//
+
+#ifndef DELAUNAY_QUADEDGE_H
+#define DELAUNAY_QUADEDGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/*
+ * Guibas-Stolfi quad-edge structure with 32-bit edge references.
+ *
+ * Quad-edge q owns the directed edges 4q .. 4q+3; 4q and 4q+2 are the primal edge and its symmetric,
+ * 4q+1 and 4q+3 the dual edges. Only onext and the origin of primal edges are stored.
+ */
+struct QuadEdge {
+    static constexpr uint32_t INVALID = 0xFFFFFFFF;
+
+    std::vector<uint32_t> onext;
+    std::vector<uint32_t> origin;
+
+    static uint32_t rot(uint32_t e) { return (e & ~3u) | ((e + 1) & 3u); }
+    static uint32_t sym(uint32_t e) { return e ^ 2u; }
+    static uint32_t invRot(uint32_t e) { return (e & ~3u) | ((e + 3) & 3u); }
+
+    uint32_t next(uint32_t e) const { return onext[e]; }
+    uint32_t oprev(uint32_t e) const { return rot(onext[rot(e)]); }
+    uint32_t lnext(uint32_t e) const { return rot(onext[invRot(e)]); }
+    uint32_t rprev(uint32_t e) const { return onext[sym(e)]; }
+
+    uint32_t org(uint32_t e) const { return origin[e]; }
+    uint32_t dest(uint32_t e) const { return origin[sym(e)]; }
+
+    void resize(size_t quadEdges) {
+        onext.resize(4 * quadEdges, INVALID);
+        origin.resize(4 * quadEdges, INVALID);
+    }
+
+    // initialize quad-edge q as an isolated edge from a to b
+    uint32_t makeEdge(uint32_t q, uint32_t a, uint32_t b) {
+        uint32_t e = 4 * q;
+        onext[e] = e;
+        onext[e + 1] = e + 3;
+        onext[e + 2] = e + 2;
+        onext[e + 3] = e + 1;
+        origin[e] = a;
+        origin[e + 2] = b;
+        return e;
+    }
+
+    void splice(uint32_t a, uint32_t b) {
+        uint32_t alpha = rot(onext[a]);
+        uint32_t beta = rot(onext[b]);
+
+        std::swap(onext[a], onext[b]);
+        std::swap(onext[alpha], onext[beta]);
+    }
+
+    // edge q from dest(a) to org(b), sharing the left face of a and b
+    uint32_t connect(uint32_t q, uint32_t a, uint32_t b) {
+        uint32_t e = makeEdge(q, dest(a), org(b));
+        splice(e, lnext(a));
+        splice(sym(e), b);
+        return e;
+    }
+
+    // detach e from the mesh, its quad-edge can be reused afterwards
+    void deleteEdge(uint32_t e) {
+        splice(e, oprev(e));
+        splice(sym(e), oprev(sym(e)));
+        origin[e & ~3u] = INVALID;
+    }
+
+    bool isAlive(uint32_t q) const { return origin[4 * q] != INVALID; }
+};
+
+
+#endif //DELAUNAY_QUADEDGE_H
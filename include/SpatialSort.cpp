@@ -0,0 +1,145 @@
+//
+// Created by lc06 on 4/20/2023.
+//
+
+#include "SpatialSort.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+static uint64_t hilbertIndex(uint32_t x, uint32_t y) {
+    uint64_t d = 0;
+    for(uint32_t s = 1u << 31; s > 0; s >>= 1) {
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        d += (uint64_t)s * s * ((3 * rx) ^ ry);
+
+        if(ry == 0) {
+            if(rx == 1) {
+                x = ~x;
+                y = ~y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+void hilbertSort(const std::vector<double>& coords, std::vector<uint32_t>::iterator begin, std::vector<uint32_t>::iterator end) {
+    if(end - begin < 2) return;
+
+    double x_min = std::numeric_limits<double>::max(), y_min = x_min;
+    double x_max = std::numeric_limits<double>::lowest(), y_max = x_max;
+    for(auto it = begin; it != end; ++it) {
+        x_min = std::min(x_min, coords[2 * *it]);
+        x_max = std::max(x_max, coords[2 * *it]);
+        y_min = std::min(y_min, coords[2 * *it + 1]);
+        y_max = std::max(y_max, coords[2 * *it + 1]);
+    }
+
+    double size = std::max(x_max - x_min, y_max - y_min);
+    double scale = size > 0. ? 4294967295. / size : 0.;
+
+    std::vector<std::pair<uint64_t, uint32_t>> keys;
+    keys.reserve(end - begin);
+    for(auto it = begin; it != end; ++it) {
+        auto x = (uint32_t)((coords[2 * *it] - x_min) * scale);
+        auto y = (uint32_t)((coords[2 * *it + 1] - y_min) * scale);
+        keys.emplace_back(hilbertIndex(x, y), *it);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    for(auto& key : keys) *begin++ = key.second;
+}
+
+// 21 bits per axis, interleaved into 63
+static uint64_t hilbertIndex3d(uint32_t x, uint32_t y, uint32_t z) {
+    uint32_t axes[3] = {x, y, z};
+
+    // Skilling: undo the excess work of the inverse transform, then Gray encode
+    for(uint32_t q = 1u << 20; q > 1; q >>= 1) {
+        uint32_t p = q - 1;
+        for(auto& axis : axes) {
+            if(axis & q) axes[0] ^= p;
+            else {
+                uint32_t t = (axes[0] ^ axis) & p;
+                axes[0] ^= t;
+                axis ^= t;
+            }
+        }
+    }
+    axes[1] ^= axes[0];
+    axes[2] ^= axes[1];
+    uint32_t t = 0;
+    for(uint32_t q = 1u << 20; q > 1; q >>= 1)
+        if(axes[2] & q) t ^= q - 1;
+    for(auto& axis : axes) axis ^= t;
+
+    uint64_t d = 0;
+    for(int b = 20; b >= 0; --b)
+        for(auto axis : axes) d = d << 1 | ((axis >> b) & 1u);
+    return d;
+}
+
+void hilbertSort3d(const std::vector<double>& coords, std::vector<uint32_t>::iterator begin, std::vector<uint32_t>::iterator end) {
+    if(end - begin < 2) return;
+
+    double low[3], high[3];
+    for(int k = 0; k < 3; ++k) {
+        low[k] = std::numeric_limits<double>::max();
+        high[k] = std::numeric_limits<double>::lowest();
+    }
+    for(auto it = begin; it != end; ++it)
+        for(int k = 0; k < 3; ++k) {
+            low[k] = std::min(low[k], coords[3 * *it + k]);
+            high[k] = std::max(high[k], coords[3 * *it + k]);
+        }
+
+    double size = std::max({high[0] - low[0], high[1] - low[1], high[2] - low[2]});
+    double scale = size > 0. ? 2097151. / size : 0.;
+
+    std::vector<std::pair<uint64_t, uint32_t>> keys;
+    keys.reserve(end - begin);
+    for(auto it = begin; it != end; ++it) {
+        auto x = (uint32_t)((coords[3 * *it] - low[0]) * scale);
+        auto y = (uint32_t)((coords[3 * *it + 1] - low[1]) * scale);
+        auto z = (uint32_t)((coords[3 * *it + 2] - low[2]) * scale);
+        keys.emplace_back(hilbertIndex3d(x, y, z), *it);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    for(auto& key : keys) *begin++ = key.second;
+}
+
+// shuffled, then rounds [0, n/2^k), ..., [n/4, n/2), [n/2, n) sorted each
+template<typename Sort>
+static std::vector<uint32_t> brio(uint32_t n, uint32_t seed, Sort sort) {
+    std::vector<uint32_t> order(n);
+    for(uint32_t i = 0; i < n; ++i) order[i] = i;
+
+    // Fisher-Yates with xorshift, so the order is reproducible across platforms
+    for(uint32_t i = n; i > 1; --i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        std::swap(order[i - 1], order[seed % i]);
+    }
+
+    uint32_t hi = n;
+    while(hi > 0) {
+        uint32_t lo = hi > 64 ? hi / 2 : 0;
+        sort(order.begin() + lo, order.begin() + hi);
+        hi = lo;
+    }
+
+    return order;
+}
+
+std::vector<uint32_t> brioOrder(const std::vector<double>& coords, uint32_t seed) {
+    return brio(coords.size() / 2, seed, [&coords](auto begin, auto end) { hilbertSort(coords, begin, end); });
+}
+
+std::vector<uint32_t> brioOrder3d(const std::vector<double>& coords, uint32_t seed) {
+    return brio(coords.size() / 3, seed, [&coords](auto begin, auto end) { hilbertSort3d(coords, begin, end); });
+}
@@ -0,0 +1,25 @@
+//
+// Created by lc06 on 4/20/2023.
+//
+
+#ifndef DELAUNAY_SPATIALSORT_H
+#define DELAUNAY_SPATIALSORT_H
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * Insertion orders for incremental triangulation.
+ *
+ * hilbertSort orders points along a Hilbert curve over their bounding square, brioOrder shuffles them and
+ * splits the result into rounds of doubling size (biased randomized insertion order), each round Hilbert
+ * sorted. The returned permutation maps insertion position to the original point index. The 3d variants
+ * take x, y, z triples and follow a 3D Hilbert curve (Skilling's transpose) over the bounding cube.
+ */
+void hilbertSort(const std::vector<double>& coords, std::vector<uint32_t>::iterator begin, std::vector<uint32_t>::iterator end);
+std::vector<uint32_t> brioOrder(const std::vector<double>& coords, uint32_t seed = 2463534242u);
+void hilbertSort3d(const std::vector<double>& coords, std::vector<uint32_t>::iterator begin, std::vector<uint32_t>::iterator end);
+std::vector<uint32_t> brioOrder3d(const std::vector<double>& coords, uint32_t seed = 2463534242u);
+
+
+#endif //DELAUNAY_SPATIALSORT_H
@@ -0,0 +1,301 @@
+//
+// Created by lc06 on 4/22/2023.
+//
+
+#include "SweepHull.h"
+#include "Predicates.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static double circumradius(const double* a, const double* b, const double* c) {
+    double dx = b[0] - a[0], dy = b[1] - a[1];
+    double ex = c[0] - a[0], ey = c[1] - a[1];
+    double bl = dx * dx + dy * dy, cl = ex * ex + ey * ey;
+    double d = 0.5 / (dx * ey - dy * ex);
+
+    double x = (ey * bl - dy * cl) * d;
+    double y = (dx * cl - ex * bl) * d;
+    return x * x + y * y;
+}
+
+template<typename K>
+uint32_t SweepHull<K>::hashKey(double x, double y) const {
+    // monotonic in the angle around the seed circumcenter, in [0, 1]
+    double dx = x - cx, dy = y - cy;
+    double p = dx / (std::fabs(dx) + std::fabs(dy));
+    double angle = (dy > 0. ? 3. - p : 1. + p) / 4.;
+    return (uint32_t)std::floor(angle * hashSize) % hashSize;
+}
+
+template<typename K>
+bool SweepHull<K>::visible(uint32_t p, uint32_t a, uint32_t b) const {
+    // the hull is counterclockwise, so edge a -> b sees p when p lies strictly to its right
+    return K::orient2d(point(a), point(b), point(p)) < 0.;
+}
+
+template<typename K>
+void SweepHull<K>::link(uint32_t a, uint32_t b) {
+    halfedges[a] = b;
+    if(b != INVALID) halfedges[b] = a;
+}
+
+template<typename K>
+uint32_t SweepHull<K>::addTriangle(uint32_t i0, uint32_t i1, uint32_t i2, uint32_t a, uint32_t b, uint32_t c) {
+    uint32_t t = trianglesLen;
+
+    triangles[t] = i0;
+    triangles[t + 1] = i1;
+    triangles[t + 2] = i2;
+
+    link(t, a);
+    link(t + 1, b);
+    link(t + 2, c);
+
+    trianglesLen += 3;
+    return t;
+}
+
+template<typename K>
+uint32_t SweepHull<K>::legalize(uint32_t a) {
+    size_t i = 0;
+    uint32_t ar;
+
+    /*
+     * flip a when p1 lies inside the circumcircle of (p0, pr, pl), then check the two edges facing p0
+     *
+     *           pl                    pl
+     *          /||\                  /  \
+     *       al/ || \bl            al/    \a
+     *        /  ||  \              /      \
+     *       /  a||b  \    flip    /___ar___\
+     *     p0\   ||   /p1   =>   p0\---bl---/p1
+     *        \  ||  /              \      /
+     *       ar\ || /br             b\    /br
+     *          \||/                  \  /
+     *           pr                    pr
+     */
+    while(true) {
+        uint32_t b = halfedges[a];
+        uint32_t a0 = a - a % 3;
+        ar = a0 + (a + 2) % 3;
+
+        if(b == INVALID) {
+            if(i == 0) break;
+            a = edgeStack[--i];
+            continue;
+        }
+
+        uint32_t b0 = b - b % 3;
+        uint32_t al = a0 + (a + 1) % 3;
+        uint32_t bl = b0 + (b + 2) % 3;
+
+        uint32_t p0 = triangles[ar];
+        uint32_t pr = triangles[a];
+        uint32_t pl = triangles[al];
+        uint32_t p1 = triangles[bl];
+
+        if(incirclePerturbed<K>(point(p0), point(pr), point(pl), point(p1)) > 0.) {
+            triangles[a] = p1;
+            triangles[b] = p0;
+
+            uint32_t hbl = halfedges[bl];
+
+            // the flipped edge was on the hull: move the hull reference over
+            if(hbl == INVALID) {
+                uint32_t e = hullStart;
+                do {
+                    if(hullTri[e] == bl) {
+                        hullTri[e] = a;
+                        break;
+                    }
+                    e = hullPrev[e];
+                } while(e != hullStart);
+            }
+
+            link(a, hbl);
+            link(b, halfedges[ar]);
+            link(ar, bl);
+
+            uint32_t br = b0 + (b + 1) % 3;
+            if(i < edgeStack.size()) edgeStack[i] = br;
+            else edgeStack.push_back(br);
+            i++;
+        }
+        else {
+            if(i == 0) break;
+            a = edgeStack[--i];
+        }
+    }
+
+    return ar;
+}
+
+template<typename K>
+void SweepHull<K>::triangulate(const double* _coords, uint32_t n, std::vector<unsigned int>& triIDs) {
+    coords = _coords;
+    if(n < 3) return;
+
+    double minX = std::numeric_limits<double>::max(), minY = minX;
+    double maxX = std::numeric_limits<double>::lowest(), maxY = maxX;
+    for(uint32_t i = 0; i < n; ++i) {
+        minX = std::min(minX, coords[2 * i]);
+        minY = std::min(minY, coords[2 * i + 1]);
+        maxX = std::max(maxX, coords[2 * i]);
+        maxY = std::max(maxY, coords[2 * i + 1]);
+    }
+    double mx = (minX + maxX) / 2., my = (minY + maxY) / 2.;
+
+    auto dist = [this](uint32_t i, double x, double y) {
+        double dx = coords[2 * i] - x, dy = coords[2 * i + 1] - y;
+        return dx * dx + dy * dy;
+    };
+
+    // seed: the point closest to the centre, its nearest neighbour and the point closing the smallest circle
+    uint32_t i0 = 0, i1 = INVALID, i2 = INVALID;
+    double minDist = std::numeric_limits<double>::infinity();
+    for(uint32_t i = 0; i < n; ++i) {
+        double d = dist(i, mx, my);
+        if(d < minDist) {
+            i0 = i;
+            minDist = d;
+        }
+    }
+
+    minDist = std::numeric_limits<double>::infinity();
+    for(uint32_t i = 0; i < n; ++i) {
+        if(i == i0) continue;
+        double d = dist(i, coords[2 * i0], coords[2 * i0 + 1]);
+        if(d < minDist && d > 0.) {
+            i1 = i;
+            minDist = d;
+        }
+    }
+    if(i1 == INVALID) return;
+
+    double minRadius = std::numeric_limits<double>::infinity();
+    for(uint32_t i = 0; i < n; ++i) {
+        if(i == i0 || i == i1) continue;
+        double r = circumradius(point(i0), point(i1), point(i));
+        if(r < minRadius) {
+            i2 = i;
+            minRadius = r;
+        }
+    }
+    // every point is collinear
+    if(i2 == INVALID) return;
+
+    if(K::orient2d(point(i0), point(i1), point(i2)) < 0.) std::swap(i1, i2);
+
+    {
+        const double* a = point(i0);
+        double dx = coords[2 * i1] - a[0], dy = coords[2 * i1 + 1] - a[1];
+        double ex = coords[2 * i2] - a[0], ey = coords[2 * i2 + 1] - a[1];
+        double bl = dx * dx + dy * dy, cl = ex * ex + ey * ey;
+        double d = 0.5 / (dx * ey - dy * ex);
+        cx = a[0] + (ey * bl - dy * cl) * d;
+        cy = a[1] + (dx * cl - ex * bl) * d;
+    }
+
+    order.resize(n);
+    for(uint32_t i = 0; i < n; ++i) order[i] = {dist(i, cx, cy), i};
+    std::sort(order.begin(), order.end());
+
+    hashSize = (uint32_t)std::ceil(std::sqrt((double)n));
+    hullPrev.assign(n, 0);
+    hullNext.assign(n, 0);
+    hullTri.assign(n, 0);
+    hullHash.assign(hashSize, INVALID);
+
+    uint32_t maxTriangles = 2 * n - 5;
+    size_t base = triIDs.size();
+    triIDs.resize(base + 3 * maxTriangles);
+    triangles = triIDs.data() + base;
+    halfedges.assign(3 * maxTriangles, INVALID);
+    trianglesLen = 0;
+
+    hullStart = i0;
+    hullNext[i0] = hullPrev[i2] = i1;
+    hullNext[i1] = hullPrev[i0] = i2;
+    hullNext[i2] = hullPrev[i1] = i0;
+
+    hullTri[i0] = 0;
+    hullTri[i1] = 1;
+    hullTri[i2] = 2;
+
+    hullHash[hashKey(coords[2 * i0], coords[2 * i0 + 1])] = i0;
+    hullHash[hashKey(coords[2 * i1], coords[2 * i1 + 1])] = i1;
+    hullHash[hashKey(coords[2 * i2], coords[2 * i2 + 1])] = i2;
+
+    addTriangle(i0, i1, i2, INVALID, INVALID, INVALID);
+
+    double xp = 0., yp = 0.;
+    for(uint32_t k = 0; k < n; ++k) {
+        uint32_t i = order[k].second;
+        double x = coords[2 * i], y = coords[2 * i + 1];
+
+        // skip duplicates and the seed
+        if(k > 0 && x == xp && y == yp) continue;
+        xp = x;
+        yp = y;
+        if(i == i0 || i == i1 || i == i2) continue;
+
+        // a visible hull edge, starting from the hull vertex hashed next to i
+        uint32_t start = 0;
+        uint32_t key = hashKey(x, y);
+        for(uint32_t j = 0; j < hashSize; ++j) {
+            start = hullHash[(key + j) % hashSize];
+            if(start != INVALID && start != hullNext[start]) break;
+        }
+
+        start = hullPrev[start];
+        uint32_t e = start, q;
+        while(q = hullNext[e], !visible(i, e, q)) {
+            e = q;
+            if(e == start) {
+                e = INVALID;
+                break;
+            }
+        }
+        // on the hull within round-off: nothing to add
+        if(e == INVALID) continue;
+
+        uint32_t t = addTriangle(e, i, hullNext[e], INVALID, INVALID, hullTri[e]);
+        hullTri[i] = legalize(t + 2);
+        hullTri[e] = t;
+
+        // walk forward through the hull, adding more triangles
+        uint32_t nv = hullNext[e];
+        while(q = hullNext[nv], visible(i, nv, q)) {
+            t = addTriangle(nv, i, q, hullTri[i], INVALID, hullTri[nv]);
+            hullTri[i] = legalize(t + 2);
+            hullNext[nv] = nv;
+            nv = q;
+        }
+
+        // and backward from the other side
+        if(e == start) {
+            while(q = hullPrev[e], visible(i, q, e)) {
+                t = addTriangle(q, i, e, INVALID, hullTri[e], hullTri[q]);
+                legalize(t + 2);
+                hullTri[q] = t;
+                hullNext[e] = e;
+                e = q;
+            }
+        }
+
+        hullStart = hullPrev[i] = e;
+        hullNext[e] = hullPrev[nv] = i;
+        hullNext[i] = nv;
+
+        hullHash[hashKey(x, y)] = i;
+        hullHash[hashKey(coords[2 * e], coords[2 * e + 1])] = e;
+    }
+
+    triIDs.resize(base + trianglesLen);
+    halfedges.resize(trianglesLen);
+}
+
+template class SweepHull<AdaptiveKernel>;
+template class SweepHull<SnappedKernel>;
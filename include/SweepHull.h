@@ -0,0 +1,59 @@
+//
+// Created by lc06 on 4/22/2023.
+//
+
+#ifndef DELAUNAY_SWEEPHULL_H
+#define DELAUNAY_SWEEPHULL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Predicates.h"
+
+/*
+ * Radial sweep-hull Delaunay triangulation (s-hull / delaunator).
+ *
+ * Starting from the seed triangle with the smallest circumcircle near the centre, points are added in
+ * order of distance from its circumcenter. Each point sees a run of convex hull edges, is fanned to
+ * them and the new triangles are legalized with edge flips. Triangles and twins are flat uint32_t
+ * arrays; the triangle array is the caller's triIDs. The scratch buffers are kept between calls.
+ * K is the predicate kernel, AdaptiveKernel or SnappedKernel.
+ */
+template<typename K>
+class SweepHull {
+public:
+    static constexpr uint32_t INVALID = 0xFFFFFFFF;
+
+    std::vector<uint32_t> halfedges;
+
+    // triangulate n points of coords (x, y pairs), appending counterclockwise triangles to triIDs
+    void triangulate(const double* coords, uint32_t n, std::vector<unsigned int>& triIDs);
+
+private:
+    const double* coords {nullptr};
+    unsigned int* triangles {nullptr};
+    uint32_t trianglesLen {0};
+
+    std::vector<uint32_t> hullPrev;
+    std::vector<uint32_t> hullNext;
+    std::vector<uint32_t> hullTri;
+    std::vector<uint32_t> hullHash;
+    uint32_t hullStart {0};
+    uint32_t hashSize {0};
+    double cx {0.}, cy {0.};
+
+    std::vector<std::pair<double, uint32_t>> order;
+    std::vector<uint32_t> edgeStack;
+
+    const double* point(uint32_t v) const { return coords + 2 * v; }
+    uint32_t hashKey(double x, double y) const;
+    bool visible(uint32_t p, uint32_t a, uint32_t b) const;
+    void link(uint32_t a, uint32_t b);
+    uint32_t addTriangle(uint32_t i0, uint32_t i1, uint32_t i2, uint32_t a, uint32_t b, uint32_t c);
+    uint32_t legalize(uint32_t a);
+};
+
+
+#endif //DELAUNAY_SWEEPHULL_H
@@ -0,0 +1,284 @@
+//
+// Created by lc06 on 5/7/2023.
+//
+
+#include "Tetrahedralization.h"
+#include "SpatialSort.h"
+
+#include <cmath>
+#include <utility>
+
+uint32_t Tetrahedralization::random() {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+uint32_t Tetrahedralization::addTet(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    uint32_t t;
+    if(!freeTets.empty()) {
+        t = freeTets.back();
+        freeTets.pop_back();
+    }
+    else {
+        t = tets.size() / 4;
+        tets.resize(tets.size() + 4);
+        neighbors.resize(neighbors.size() + 4);
+        stamps.push_back(0);
+    }
+
+    tets[4 * t] = a;
+    tets[4 * t + 1] = b;
+    tets[4 * t + 2] = c;
+    tets[4 * t + 3] = d;
+    neighbors[4 * t] = neighbors[4 * t + 1] = neighbors[4 * t + 2] = neighbors[4 * t + 3] = INVALID;
+
+    return t;
+}
+
+// pair up faces 0, 1, 2 of the new tets, which all have the same fourth vertex: face k shares the other
+// two vertices with exactly one other such face
+void Tetrahedralization::linkAround(const std::vector<uint32_t>& created) {
+    const uint64_t EMPTY = ~0ull;
+    size_t capacity = 16;
+    while(capacity < 4 * created.size()) capacity *= 2;
+    edgeKeys.assign(capacity, EMPTY);
+    edgeFaces.resize(capacity);
+
+    for(uint32_t t : created)
+        for(uint32_t k = 0; k < 3; ++k) {
+            uint32_t u = tets[4 * t + (k + 1) % 3], w = tets[4 * t + (k + 2) % 3];
+            if(u > w) std::swap(u, w);
+            uint64_t key = (uint64_t)u << 32 | w;
+
+            size_t i = (u * 0x9e3779b1u ^ w * 0x85ebca6bu) & (capacity - 1);
+            while(edgeKeys[i] != EMPTY && edgeKeys[i] != key) i = (i + 1) & (capacity - 1);
+            if(edgeKeys[i] == key) link(edgeFaces[i], 4 * t + k);
+            else {
+                edgeKeys[i] = key;
+                edgeFaces[i] = 4 * t + k;
+            }
+        }
+}
+
+// the first vertex, the first one apart from it and the first one off their line are kept as they arrive,
+// so every vertex before the first tet is tested once; the first vertex off their plane completes it
+bool Tetrahedralization::initialize(uint32_t v) {
+    waiting.push_back(v);
+
+    auto collinear = [this](uint32_t a, uint32_t b, uint32_t c) {
+        const double *pa = point(a), *pb = point(b), *pc = point(c);
+        for(int k = 0; k < 3; ++k) {
+            int i = k, j = (k + 1) % 3;
+            const double qa[2] = {pa[i], pa[j]}, qb[2] = {pb[i], pb[j]}, qc[2] = {pc[i], pc[j]};
+            if(orient2d(qa, qb, qc) != 0.) return false;
+        }
+        return true;
+    };
+
+    uint32_t &a = seeds[0], &b = seeds[1], &c = seeds[2];
+    if(a == INVALID) {
+        a = v;
+        return false;
+    }
+    if(b == INVALID) {
+        const double *p = point(v), *q = point(a);
+        if(p[0] != q[0] || p[1] != q[1] || p[2] != q[2]) b = v;
+        return false;
+    }
+    if(c == INVALID) {
+        if(!collinear(a, b, v)) c = v;
+        return false;
+    }
+
+    double side = orient3d(point(a), point(b), point(c), point(v));
+    if(side == 0.) return false;
+    uint32_t d = v;
+    if(side < 0.) std::swap(a, b);
+
+    // the tet and a ghost on each of its faces
+    uint32_t t = addTet(a, b, c, d);
+    std::vector<uint32_t> ghosts;
+    for(uint32_t f = 0; f < 4; ++f) {
+        uint32_t x = tets[4 * t + FACES[f][0]], y = tets[4 * t + FACES[f][1]], z = tets[4 * t + FACES[f][2]];
+        uint32_t g = addTet(x, z, y, INFINITE);
+        link(4 * t + f, 4 * g + 3);
+        ghosts.push_back(g);
+    }
+    linkAround(ghosts);
+    last = t;
+    return true;
+}
+
+bool Tetrahedralization::ghostConflict(uint32_t a, uint32_t b, uint32_t c, const double* p) const {
+    const double *pa = point(a), *pb = point(b), *pc = point(c);
+
+    double o = orient3d(pa, pb, pc, p);
+    if(o > 0.) return true;
+    if(o < 0.) return false;
+
+    // on the hull plane: only a point inside the circumcircle of abc breaks the hull facet. That circle
+    // is where the plane cuts any sphere through a, b, c, e.g. the one through a point off the plane
+    double ux = pb[0] - pa[0], uy = pb[1] - pa[1], uz = pb[2] - pa[2];
+    double vx = pc[0] - pa[0], vy = pc[1] - pa[1], vz = pc[2] - pa[2];
+    double nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+    double scale = (std::sqrt(ux * ux + uy * uy + uz * uz) + std::sqrt(vx * vx + vy * vy + vz * vz))
+                   / std::sqrt(nx * nx + ny * ny + nz * nz);
+    const double q[3] = {pa[0] + nx * scale, pa[1] + ny * scale, pa[2] + nz * scale};
+
+    double side = orient3d(pa, pb, pc, q);
+    if(side > 0.) return insphere(pa, pb, pc, q, p) > 0.;
+    if(side < 0.) return insphere(pa, pc, pb, q, p) > 0.;
+    return false;
+}
+
+bool Tetrahedralization::conflict(uint32_t t, const double* p) const {
+    for(uint32_t i = 0; i < 4; ++i)
+        if(tets[4 * t + i] == INFINITE)
+            return ghostConflict(tets[4 * t + FACES[i][0]], tets[4 * t + FACES[i][1]], tets[4 * t + FACES[i][2]], p);
+
+    return insphere(point(tets[4 * t]), point(tets[4 * t + 1]), point(tets[4 * t + 2]), point(tets[4 * t + 3]), p) > 0.;
+}
+
+uint32_t Tetrahedralization::locate(const double* p, uint32_t hint) {
+    if(tets.empty()) return INVALID;
+
+    uint32_t t = hint != INVALID && hint < tets.size() / 4 && isAlive(hint) ? hint : last;
+    if(t == INVALID || !isAlive(t)) {
+        t = 0;
+        while(!isAlive(t)) t++;
+    }
+
+    // step from a ghost tet onto the hull
+    if(isGhost(t)) {
+        for(uint32_t i = 0; i < 4; ++i)
+            if(tets[4 * t + i] == INFINITE) {
+                t = neighbors[4 * t + i] / 4;
+                break;
+            }
+    }
+
+    // visibility walk, starting at a random face and never back through the one it came in by
+    uint32_t from = INVALID;
+    while(!isGhost(t)) {
+        uint32_t r = random(), next = INVALID;
+        for(uint32_t k = 0; k < 4; ++k) {
+            uint32_t i = (r + k) & 3;
+            if(4 * t + i == from) continue;
+
+            const uint32_t* face = FACES[i];
+            if(orient3d(point(tets[4 * t + face[0]]), point(tets[4 * t + face[1]]), point(tets[4 * t + face[2]]), p) < 0.) {
+                next = neighbors[4 * t + i];
+                break;
+            }
+        }
+        if(next == INVALID) return t;
+        from = next;
+        t = next / 4;
+    }
+    return t;
+}
+
+bool Tetrahedralization::insert(uint32_t v, uint32_t hint) {
+    if(tets.empty()) {
+        if(!initialize(v)) return true;
+
+        // the held back vertices in arrival order, the corners of the first tet are in it already
+        std::vector<uint32_t> rest;
+        rest.swap(waiting);
+        for(auto u : rest)
+            if(u != seeds[0] && u != seeds[1] && u != seeds[2] && u != v) insert(u);
+        return true;
+    }
+
+    const double* p = point(v);
+    uint32_t t = locate(p, hint);
+
+    if(!isGhost(t)) {
+        for(uint32_t i = 0; i < 4; ++i) {
+            const double* q = point(tets[4 * t + i]);
+            if(q[0] == p[0] && q[1] == p[1] && q[2] == p[2]) return false;
+        }
+    }
+
+    // grow the cavity of tets whose circumsphere contains p, its boundary faces stay with the tet beyond
+    stamp++;
+    cavity.clear();
+    boundary.clear();
+
+    pending.clear();
+    pending.push_back(t);
+    stamps[t] = stamp;
+    while(!pending.empty()) {
+        uint32_t c = pending.back();
+        pending.pop_back();
+        cavity.push_back(c);
+
+        for(uint32_t i = 0; i < 4; ++i) {
+            uint32_t f = neighbors[4 * c + i], u = f / 4;
+            if(stamps[u] == stamp) continue;
+
+            if(conflict(u, p)) {
+                stamps[u] = stamp;
+                pending.push_back(u);
+            }
+            else boundary.push_back({tets[4 * c + FACES[i][0]], tets[4 * c + FACES[i][1]], tets[4 * c + FACES[i][2]], f});
+        }
+    }
+
+    // the cavity becomes a star of tets around v, in the freed slots first
+    for(auto c : cavity) {
+        tets[4 * c] = INVALID;
+        freeTets.push_back(c);
+    }
+    for(auto& facet : boundary) {
+        uint32_t n = addTet(facet.a, facet.b, facet.c, v);
+        link(4 * n + 3, facet.outer);
+        pending.push_back(n);
+        if(facet.a != INFINITE && facet.b != INFINITE && facet.c != INFINITE) last = n;
+    }
+    linkAround(pending);
+    pending.clear();
+
+    return true;
+}
+
+uint32_t Tetrahedralization::triangulate() {
+    uint32_t n = coords.size() / 3;
+
+    // about 6.5 tets per point, reserved up front so the arrays do not double past the memory at the end
+    tets.reserve(28 * (size_t)n);
+    neighbors.reserve(28 * (size_t)n);
+    stamps.reserve(7 * (size_t)n);
+
+    // the coordinates are laid out in insertion order while inserting, so neighbouring tets share cache lines
+    std::vector<uint32_t> order = brioOrder3d(coords);
+    std::vector<double> sorted(coords.size());
+    for(uint32_t k = 0; k < n; ++k)
+        for(int i = 0; i < 3; ++i) sorted[3 * k + i] = coords[3 * order[k] + i];
+    coords.swap(sorted);
+
+    for(uint32_t k = 0; k < n; ++k) insert(k);
+
+    coords.swap(sorted);
+    for(auto& v : tets)
+        if(v < INFINITE) v = order[v];
+
+    // repeated points, and all of them if they are coplanar, are in no tet
+    std::vector<char> used(n, 0);
+    for(uint32_t t = 0; t < tets.size() / 4; ++t)
+        if(isAlive(t) && !isGhost(t))
+            for(uint32_t i = 0; i < 4; ++i) used[tets[4 * t + i]] = 1;
+
+    uint32_t count = 0;
+    for(auto u : used) count += u;
+    return count;
+}
+
+std::vector<uint32_t> Tetrahedralization::getTetrahedra() const {
+    std::vector<uint32_t> result;
+    for(uint32_t t = 0; t < tets.size() / 4; ++t)
+        if(isAlive(t) && !isGhost(t)) result.insert(result.end(), tets.begin() + 4 * t, tets.begin() + 4 * t + 4);
+    return result;
+}
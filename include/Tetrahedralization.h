@@ -0,0 +1,95 @@
+//
+// Created by lc06 on 5/7/2023.
+//
+
+#ifndef DELAUNAY_TETRAHEDRALIZATION_H
+#define DELAUNAY_TETRAHEDRALIZATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Predicates.h"
+
+/*
+ * Incremental (Bowyer-Watson) Delaunay tetrahedralization of 3D points.
+ *
+ * Tetrahedra are stored as flat arrays, four vertices and four neighbours each, 32 bytes a tet: face i of
+ * tet t is the one opposite tets[4t + i] and neighbors[4t + i] = 4u + j says it is face j of tet u. Every
+ * tet is positively oriented, orient3d(a, b, c, d) > 0. The convex hull is closed with ghost tets sharing
+ * the vertex INFINITE, so points outside the hull are inserted exactly like points inside it, and the
+ * slots of the tets a cavity frees are reused by the ones filling it.
+ *
+ * triangulate inserts in BRIO order along a 3D Hilbert curve, so the visibility walk from the last new
+ * tet rarely takes more than a few steps; a Delaunay tetrahedralization has about 6.5 tets per point,
+ * about 240 bytes per point with the coordinates.
+ */
+class Tetrahedralization {
+public:
+    static constexpr uint32_t INVALID = 0xFFFFFFFF;
+    static constexpr uint32_t INFINITE = 0xFFFFFFFE;
+
+    std::vector<double> coords;         // x, y, z per vertex
+    std::vector<uint32_t> tets;
+    std::vector<uint32_t> neighbors;
+
+    Tetrahedralization() = default;
+    explicit Tetrahedralization(std::vector<double> _coords) : coords(std::move(_coords)) {}
+
+    // insert every vertex in BRIO order, returns the number of vertices actually inserted
+    uint32_t triangulate();
+    // insert a single vertex, false if it duplicates an existing one; vertices arriving before the
+    // first non-degenerate tet are held back until it exists
+    bool insert(uint32_t v, uint32_t hint = INVALID);
+
+    // tet containing p, or the ghost tet whose outer half-space contains it, walking from hint or from
+    // the last new tet
+    uint32_t locate(const double* p, uint32_t hint = INVALID);
+
+    bool isGhost(uint32_t t) const {
+        return tets[4 * t] == INFINITE || tets[4 * t + 1] == INFINITE || tets[4 * t + 2] == INFINITE || tets[4 * t + 3] == INFINITE;
+    }
+    bool isAlive(uint32_t t) const { return tets[4 * t] != INVALID; }
+
+    // vertices of the finite tets, four each, compacted
+    std::vector<uint32_t> getTetrahedra() const;
+
+private:
+    // the vertices of face i, ordered so that orient3d(face, tets[4t + i]) > 0
+    static constexpr uint32_t FACES[4][3] = {{1, 3, 2}, {0, 2, 3}, {0, 3, 1}, {0, 1, 2}};
+
+    struct Facet {
+        uint32_t a, b, c;
+        uint32_t outer;                 // the face beyond it, 4u + j
+    };
+
+    std::vector<uint32_t> freeTets;
+    std::vector<uint32_t> stamps;
+    uint32_t stamp {0};
+    uint32_t last {INVALID};
+    uint32_t seed {2463534242u};
+
+    std::vector<uint32_t> waiting;      // vertices held back until the first tet
+    uint32_t seeds[3] {INVALID, INVALID, INVALID};  // its first corners found so far
+    std::vector<uint32_t> pending;
+    std::vector<uint32_t> cavity;
+    std::vector<Facet> boundary;
+    std::vector<uint64_t> edgeKeys;     // open-addressing table of the new faces around a vertex
+    std::vector<uint32_t> edgeFaces;
+
+    const double* point(uint32_t v) const { return &coords[3 * v]; }
+
+    bool initialize(uint32_t v);
+    bool conflict(uint32_t t, const double* p) const;
+    bool ghostConflict(uint32_t a, uint32_t b, uint32_t c, const double* p) const;
+    uint32_t addTet(uint32_t a, uint32_t b, uint32_t c, uint32_t d);
+    void link(uint32_t f, uint32_t g) {
+        neighbors[f] = g;
+        neighbors[g] = f;
+    }
+    void linkAround(const std::vector<uint32_t>& created);
+    uint32_t random();
+};
+
+
+#endif //DELAUNAY_TETRAHEDRALIZATION_H
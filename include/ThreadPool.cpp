@@ -0,0 +1,67 @@
+//
+// Created by lc06 on 5/1/2023.
+//
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int threads) {
+    for(unsigned int k = 1; k < threads; ++k) workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for(auto& worker : workers) worker.join();
+}
+
+void ThreadPool::drain() {
+    for(size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) (*task)(i);
+}
+
+void ThreadPool::work() {
+    unsigned int seen = 0;
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]() { return stopping || generation != seen; });
+            if(stopping) return;
+            seen = generation;
+        }
+
+        drain();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if(--active == 0) finished.notify_one();
+    }
+}
+
+void ThreadPool::parallelFor(size_t _count, const std::function<void(size_t)>& _task) {
+    if(workers.empty() || _count < 2) {
+        for(size_t i = 0; i < _count; ++i) _task(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &_task;
+        count = _count;
+        next = 0;
+        active = workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&]() { return active == 0; });
+}
+
+void ThreadPool::parallelRanges(size_t _count, size_t chunk, const std::function<void(size_t, size_t)>& _task) {
+    parallelFor((_count + chunk - 1) / chunk, [&](size_t k) { _task(k * chunk, std::min(_count, (k + 1) * chunk)); });
+}
@@ -0,0 +1,58 @@
+//
+// Created by lc06 on 5/1/2023.
+//
+
+#ifndef DELAUNAY_THREADPOOL_H
+#define DELAUNAY_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Fixed set of worker threads for fork-join loops.
+ *
+ * parallelFor hands out the indices one at a time through an atomic counter, the calling thread works
+ * along and the call returns once every index is done. Workers sleep on a condition variable between
+ * loops, so a pool can be kept for the whole triangulation and fed many small loops.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned int threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator = (const ThreadPool&) = delete;
+
+    // threads taking part in a loop, the caller included
+    unsigned int size() const { return workers.size() + 1; }
+
+    // task(i) for every i in [0, count)
+    void parallelFor(size_t count, const std::function<void(size_t)>& task);
+    // task(begin, end) over [0, count) in ranges of chunk indices, for loops whose body is too cheap to
+    // be handed out one index at a time
+    void parallelRanges(size_t count, size_t chunk, const std::function<void(size_t, size_t)>& task);
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+
+    const std::function<void(size_t)>* task {nullptr};
+    size_t count {0};
+    std::atomic<size_t> next {0};
+    unsigned int generation {0};
+    unsigned int active {0};
+    bool stopping {false};
+
+    void work();
+    void drain();
+};
+
+
+#endif //DELAUNAY_THREADPOOL_H
@@ -0,0 +1,644 @@
+//
+// Created by lc06 on 4/18/2023.
+//
+
+#include "Triangulation.h"
+#include "Predicates.h"
+
+#include <utility>
+
+template<typename K>
+BasicTriangulation<K>::BasicTriangulation(std::vector<double> _coords) : coords(std::move(_coords)) {
+    vertexEdge.assign(coords.size() / 2, INVALID);
+}
+
+template<typename K>
+uint32_t BasicTriangulation<K>::addVertex(double x, double y) {
+    coords.push_back(x);
+    coords.push_back(y);
+    vertexEdge.push_back(INVALID);
+    return vertexEdge.size() - 1;
+}
+
+template<typename K>
+void BasicTriangulation<K>::adopt(std::vector<uint32_t> _triangles, std::vector<uint32_t> _halfedges) {
+    triangles = std::move(_triangles);
+    halfedges = std::move(_halfedges);
+    stamps.assign(triangles.size() / 3, 0);
+    freeTriangles.clear();
+    waiting.clear();
+
+    last = INVALID;
+    for(uint32_t e = 0; e < triangles.size(); ++e) {
+        if(!isAlive(e / 3) || isGhost(e / 3)) continue;
+        vertexEdge[triangles[e]] = e;
+        last = e / 3;
+    }
+}
+
+template<typename K>
+uint32_t BasicTriangulation<K>::random() {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+template<typename K>
+uint32_t BasicTriangulation<K>::addTriangle(uint32_t a, uint32_t b, uint32_t c) {
+    uint32_t t;
+    if(!freeTriangles.empty()) {
+        t = freeTriangles.back();
+        freeTriangles.pop_back();
+    }
+    else {
+        t = triangles.size() / 3;
+        triangles.resize(triangles.size() + 3);
+        halfedges.resize(halfedges.size() + 3);
+        stamps.push_back(0);
+    }
+
+    triangles[3 * t] = a;
+    triangles[3 * t + 1] = b;
+    triangles[3 * t + 2] = c;
+    halfedges[3 * t] = halfedges[3 * t + 1] = halfedges[3 * t + 2] = INVALID;
+    added.push_back(t);
+
+    return t;
+}
+
+template<typename K>
+bool BasicTriangulation<K>::initialize(const std::vector<uint32_t>& order, std::vector<uint32_t>& skipped) {
+    if(order.size() < 3) return false;
+
+    // first two distinct points, then the first point not collinear with them
+    uint32_t a = order[0], b = INVALID, c = INVALID;
+    size_t i = 1;
+    for(; i < order.size(); ++i) {
+        if(coords[2 * order[i]] != coords[2 * a] || coords[2 * order[i] + 1] != coords[2 * a + 1]) {
+            b = order[i++];
+            break;
+        }
+        skipped.push_back(order[i]);
+    }
+    for(; b != INVALID && i < order.size(); ++i) {
+        if(K::orient2d(point(a), point(b), point(order[i])) != 0.) {
+            c = order[i++];
+            break;
+        }
+        skipped.push_back(order[i]);
+    }
+    if(c == INVALID) return false;
+
+    if(K::orient2d(point(a), point(b), point(c)) < 0.) std::swap(b, c);
+
+    uint32_t t = addTriangle(a, b, c);
+    uint32_t g0 = addTriangle(b, a, INFINITE);
+    uint32_t g1 = addTriangle(c, b, INFINITE);
+    uint32_t g2 = addTriangle(a, c, INFINITE);
+
+    auto link = [this](uint32_t e1, uint32_t e2) {
+        halfedges[e1] = e2;
+        halfedges[e2] = e1;
+    };
+    link(3 * t, 3 * g0);
+    link(3 * t + 1, 3 * g1);
+    link(3 * t + 2, 3 * g2);
+    link(3 * g0 + 1, 3 * g2 + 2);
+    link(3 * g1 + 1, 3 * g0 + 2);
+    link(3 * g2 + 1, 3 * g1 + 2);
+
+    vertexEdge[a] = 3 * t;
+    vertexEdge[b] = 3 * t + 1;
+    vertexEdge[c] = 3 * t + 2;
+    last = t;
+
+    skipped.insert(skipped.end(), order.begin() + i, order.end());
+    return true;
+}
+
+template<typename K>
+uint32_t BasicTriangulation<K>::insert(const std::vector<uint32_t>& order) {
+    uint32_t count = 0;
+    for(auto v : order)
+        if(insert(v)) count++;
+
+    return count;
+}
+
+template<typename K>
+bool BasicTriangulation<K>::ghostConflict(uint32_t a, uint32_t b, const double* p) const {
+    const double* pa = point(a);
+    const double* pb = point(b);
+
+    double o = K::orient2d(pa, pb, p);
+    if(o > 0.) return true;
+    if(o < 0.) return false;
+
+    // on the hull line: only a point strictly between a and b breaks the hull edge
+    double dot = (p[0] - pa[0]) * (pb[0] - pa[0]) + (p[1] - pa[1]) * (pb[1] - pa[1]);
+    double len = (pb[0] - pa[0]) * (pb[0] - pa[0]) + (pb[1] - pa[1]) * (pb[1] - pa[1]);
+    return dot > 0. && dot < len;
+}
+
+template<typename K>
+bool BasicTriangulation<K>::conflict(uint32_t t, const double* p) const {
+    uint32_t a = triangles[3 * t], b = triangles[3 * t + 1], c = triangles[3 * t + 2];
+
+    if(a == INFINITE) return ghostConflict(b, c, p);
+    if(b == INFINITE) return ghostConflict(c, a, p);
+    if(c == INFINITE) return ghostConflict(a, b, p);
+
+    return incirclePerturbed<K>(point(a), point(b), point(c), p) > 0.;
+}
+
+template<typename K>
+uint32_t BasicTriangulation<K>::locate(double x, double y, uint32_t hint) {
+    if(triangles.empty()) return INVALID;
+
+    uint32_t t = hint != INVALID && hint < triangles.size() / 3 && isAlive(hint) ? hint : last;
+    if(t == INVALID || !isAlive(t)) t = jump(x, y);
+    if(t == INVALID || !isAlive(t)) {
+        t = 0;
+        while(!isAlive(t)) t++;
+    }
+
+    // step from a ghost triangle onto the hull
+    if(isGhost(t)) {
+        for(uint32_t i = 0; i < 3; ++i)
+            if(triangles[3 * t + i] != INFINITE && triangles[3 * t + (i + 1) % 3] != INFINITE) {
+                t = halfedges[3 * t + i] / 3;
+                break;
+            }
+    }
+
+    const double p[2] = {x, y};
+
+    // remembering stochastic walk
+    while(true) {
+        uint32_t start = random() % 3;
+        bool moved = false;
+
+        for(uint32_t k = 0; k < 3; ++k) {
+            uint32_t e = 3 * t + (start + k) % 3;
+            if(K::orient2d(point(triangles[e]), point(triangles[next(e)]), p) < 0.) {
+                t = halfedges[e] / 3;
+                moved = true;
+                break;
+            }
+        }
+
+        if(!moved || isGhost(t)) return t;
+    }
+}
+
+template<typename K>
+uint32_t BasicTriangulation<K>::jump(double x, double y) {
+    uint32_t n = vertexEdge.size();
+    if(n == 0) return INVALID;
+
+    uint32_t samples = 1;
+    while(samples * samples < n) samples++;
+
+    uint32_t best = INVALID;
+    double bestDist = 0.;
+    for(uint32_t k = 0; k < samples; ++k) {
+        uint32_t v = random() % n;
+        if(vertexEdge[v] == INVALID) continue;
+
+        double dx = coords[2 * v] - x, dy = coords[2 * v + 1] - y;
+        double dist = dx * dx + dy * dy;
+        if(best == INVALID || dist < bestDist) {
+            best = v;
+            bestDist = dist;
+        }
+    }
+
+    return best == INVALID ? INVALID : vertexEdge[best] / 3;
+}
+
+template<typename K>
+uint32_t BasicTriangulation<K>::nearestVertex(uint32_t t, double x, double y) const {
+    uint32_t best = INVALID;
+    double bestDist = 0.;
+    for(uint32_t i = 0; i < 3; ++i) {
+        uint32_t v = triangles[3 * t + i];
+        if(v == INFINITE) continue;
+
+        double dx = coords[2 * v] - x, dy = coords[2 * v + 1] - y;
+        double dist = dx * dx + dy * dy;
+        if(best == INVALID || dist < bestDist) {
+            best = v;
+            bestDist = dist;
+        }
+    }
+    return best;
+}
+
+template<typename K>
+bool BasicTriangulation<K>::insert(uint32_t v, uint32_t hint) {
+    cavity.clear();
+    added.clear();
+    repeats.clear();
+
+    if(triangles.empty()) {
+        waiting.push_back(v);
+
+        std::vector<uint32_t> rest;
+        if(!initialize(waiting, rest)) return true;
+
+        // the held back vertices go in now, the repeats among them are reported
+        waiting.clear();
+        std::vector<uint32_t> duplicates;
+        for(auto u : rest)
+            if(!insert(u)) duplicates.push_back(u);
+        repeats.swap(duplicates);
+        return true;
+    }
+
+    const double* p = point(v);
+    uint32_t t = locate(p[0], p[1], hint);
+
+    if(!isGhost(t)) {
+        for(uint32_t i = 0; i < 3; ++i) {
+            const double* q = point(triangles[3 * t + i]);
+            if(q[0] == p[0] && q[1] == p[1]) return false;
+        }
+    }
+
+    // grow the cavity of triangles whose circumcircle contains p
+    stamp++;
+    boundary.clear();
+
+    pending.clear();
+    pending.push_back(t);
+    stamps[t] = stamp;
+
+    while(!pending.empty()) {
+        uint32_t u = pending.back();
+        pending.pop_back();
+        cavity.push_back(u);
+
+        for(uint32_t i = 0; i < 3; ++i) {
+            uint32_t e = 3 * u + i;
+            uint32_t n = halfedges[e] / 3;
+            if(stamps[n] == stamp) continue;
+
+            if(conflict(n, p)) {
+                stamps[n] = stamp;
+                pending.push_back(n);
+            }
+            else boundary.push_back(e);
+        }
+    }
+
+    // boundary edges as (from, to, outer twin) before the cavity slots are reused
+    size_t count = boundary.size();
+    for(size_t i = 0; i < count; ++i) {
+        uint32_t e = boundary[i];
+        boundary.push_back(triangles[e]);
+        boundary.push_back(triangles[next(e)]);
+        boundary.push_back(halfedges[e]);
+    }
+
+    for(auto u : cavity) {
+        triangles[3 * u] = INVALID;
+        freeTriangles.push_back(u);
+    }
+
+    // fan the cavity boundary around v
+    uint32_t infiniteEdge = INVALID;
+    for(size_t i = 0; i < count; ++i) {
+        uint32_t a = boundary[count + 3 * i];
+        uint32_t b = boundary[count + 3 * i + 1];
+        uint32_t o = boundary[count + 3 * i + 2];
+
+        uint32_t n = addTriangle(a, b, v);
+        halfedges[3 * n] = o;
+        halfedges[o] = 3 * n;
+
+        if(a == INFINITE) infiniteEdge = 3 * n;
+        else vertexEdge[a] = 3 * n;
+        if(a != INFINITE && b != INFINITE) last = n;
+    }
+
+    for(size_t i = 0; i < count; ++i) {
+        uint32_t b = boundary[count + 3 * i + 1];
+        uint32_t n = halfedges[boundary[count + 3 * i + 2]] / 3;
+        uint32_t m = (b == INFINITE ? infiniteEdge : vertexEdge[b]) / 3;
+
+        halfedges[3 * n + 1] = 3 * m + 2;
+        halfedges[3 * m + 2] = 3 * n + 1;
+    }
+
+    vertexEdge[v] = 3 * (halfedges[boundary[count + 2]] / 3) + 2;
+    return true;
+}
+
+template<typename K>
+bool BasicTriangulation<K>::ear(const std::vector<uint32_t>& polygon, size_t i) const {
+    size_t n = polygon.size();
+    uint32_t a = polygon[(i + n - 1) % n], b = polygon[i], c = polygon[(i + 1) % n];
+
+    // a ghost ear is a new hull edge: nothing of the polygon may lie outside it
+    if(a == INFINITE || b == INFINITE) {
+        uint32_t u = a == INFINITE ? b : c, w = a == INFINITE ? c : a;
+        a = u, b = w, c = INFINITE;
+    }
+    if(c == INFINITE) {
+        for(auto d : polygon)
+            if(d != a && d != b && d != INFINITE && ghostConflict(a, b, point(d))) return false;
+        return true;
+    }
+
+    if(K::orient2d(point(a), point(b), point(c)) <= 0.) return false;
+    for(auto d : polygon)
+        if(d != a && d != b && d != c && d != INFINITE && incirclePerturbed<K>(point(a), point(b), point(c), point(d)) > 0.) return false;
+    return true;
+}
+
+template<typename K>
+bool BasicTriangulation<K>::remove(uint32_t v) {
+    cavity.clear();
+    added.clear();
+    if(v >= vertexEdge.size() || vertexEdge[v] == INVALID) return false;
+
+    // star of v counterclockwise: link vertex i, and the outer twin of the link edge from i to i + 1
+    std::vector<uint32_t> polygon;
+    boundary.clear();
+    uint32_t start = vertexEdge[v], e = start;
+    do {
+        cavity.push_back(e / 3);
+        polygon.push_back(triangles[next(e)]);
+        boundary.push_back(halfedges[next(e)]);
+        e = halfedges[prev(e)];
+    } while(e != start);
+
+    // plan the ears first, so a hole that cannot be filled leaves the triangulation untouched
+    ring.resize(polygon.size());
+    for(uint32_t i = 0; i < ring.size(); ++i) ring[i] = i;
+    std::vector<uint32_t> cuts, remaining = polygon;
+    while(remaining.size() > 3) {
+        size_t i = 0;
+        while(i < remaining.size() && !ear(remaining, i)) i++;
+        if(i == remaining.size()) return false;
+
+        size_t n = remaining.size();
+        cuts.push_back(ring[(i + n - 1) % n]);
+        cuts.push_back(ring[i]);
+        cuts.push_back(ring[(i + 1) % n]);
+
+        remaining.erase(remaining.begin() + i);
+        ring.erase(ring.begin() + i);
+    }
+    cuts.insert(cuts.end(), ring.begin(), ring.end());
+
+    // ghost ears alone are fine while a finite triangle stays beyond the star; the finite triangles are
+    // edge-connected, so one of them would be across a link edge. Otherwise the rest is collinear
+    bool finite = false;
+    for(size_t k = 0; k < cuts.size() && !finite; k += 3)
+        finite = polygon[cuts[k]] != INFINITE && polygon[cuts[k + 1]] != INFINITE && polygon[cuts[k + 2]] != INFINITE;
+    for(size_t i = 0; i < boundary.size() && !finite; ++i)
+        finite = !isGhost(boundary[i] / 3);
+    if(!finite) return false;
+
+    for(auto t : cavity) {
+        triangles[3 * t] = INVALID;
+        freeTriangles.push_back(t);
+    }
+    vertexEdge[v] = INVALID;
+
+    auto link = [this](uint32_t e1, uint32_t e2) {
+        halfedges[e1] = e2;
+        halfedges[e2] = e1;
+    };
+
+    // boundary[i] is the current outer twin of the polygon edge leaving link vertex i
+    for(size_t k = 0; k < cuts.size(); k += 3) {
+        uint32_t i = cuts[k], j = cuts[k + 1], l = cuts[k + 2];
+        uint32_t t = addTriangle(polygon[i], polygon[j], polygon[l]);
+        link(3 * t, boundary[i]);
+        link(3 * t + 1, boundary[j]);
+        if(k + 3 == cuts.size()) link(3 * t + 2, boundary[l]);
+        else boundary[i] = 3 * t + 2;
+
+        for(uint32_t r = 0; r < 3; ++r)
+            if(triangles[3 * t + r] != INFINITE) vertexEdge[triangles[3 * t + r]] = 3 * t + r;
+        if(!isGhost(t)) last = t;
+    }
+    return true;
+}
+
+template<typename K>
+void BasicTriangulation<K>::flip(uint32_t e) {
+    /*
+     *      c                c
+     *     / \              /|\
+     *    a---b    ->      a | b
+     *     \ /              \|/
+     *      d                d
+     */
+    uint32_t f = halfedges[e];
+    uint32_t t1 = e / 3, t2 = f / 3;
+    uint32_t a = triangles[e], b = triangles[next(e)], c = triangles[prev(e)], d = triangles[prev(f)];
+    uint32_t ca = halfedges[prev(e)], ad = halfedges[next(f)], db = halfedges[prev(f)], bc = halfedges[next(e)];
+
+    triangles[3 * t1] = c;
+    triangles[3 * t1 + 1] = a;
+    triangles[3 * t1 + 2] = d;
+    triangles[3 * t2] = d;
+    triangles[3 * t2 + 1] = b;
+    triangles[3 * t2 + 2] = c;
+
+    auto link = [this](uint32_t e1, uint32_t e2) {
+        halfedges[e1] = e2;
+        halfedges[e2] = e1;
+    };
+    link(3 * t1, ca);
+    link(3 * t1 + 1, ad);
+    link(3 * t2, db);
+    link(3 * t2 + 1, bc);
+    link(3 * t1 + 2, 3 * t2 + 2);
+
+    vertexEdge[c] = 3 * t1;
+    vertexEdge[a] = 3 * t1 + 1;
+    vertexEdge[d] = 3 * t2;
+    vertexEdge[b] = 3 * t2 + 1;
+
+    // flipped slots are reported as freed and created at once
+    for(uint32_t t : {t1, t2}) {
+        if(stamps[t] == stamp) continue;
+        stamps[t] = stamp;
+        cavity.push_back(t);
+        added.push_back(t);
+    }
+}
+
+template<typename K>
+void BasicTriangulation<K>::split(uint32_t t, uint32_t v) {
+    /*
+     *      c                c
+     *     / \              /|\
+     *    /   \    ->      / v \
+     *   a-----b          a-----b
+     */
+    stamp++;
+    cavity.clear();
+    added.clear();
+
+    uint32_t a = triangles[3 * t], b = triangles[3 * t + 1], c = triangles[3 * t + 2];
+    uint32_t bc = halfedges[3 * t + 1], ca = halfedges[3 * t + 2];
+
+    triangles[3 * t + 2] = v;
+    uint32_t t1 = addTriangle(b, c, v), t2 = addTriangle(c, a, v);
+    for(uint32_t s : {t, t1, t2}) stamps[s] = stamp;
+    cavity.push_back(t);
+    added.push_back(t);
+
+    auto link = [this](uint32_t e1, uint32_t e2) {
+        halfedges[e1] = e2;
+        halfedges[e2] = e1;
+    };
+    link(3 * t1, bc);
+    link(3 * t2, ca);
+    link(3 * t + 1, 3 * t1 + 2);
+    link(3 * t1 + 1, 3 * t2 + 2);
+    link(3 * t2 + 1, 3 * t + 2);
+
+    vertexEdge[a] = 3 * t;
+    vertexEdge[b] = 3 * t1;
+    vertexEdge[c] = 3 * t2;
+    vertexEdge[v] = 3 * t + 2;
+    last = t;
+}
+
+template<typename K>
+void BasicTriangulation<K>::splitEdge(uint32_t e, uint32_t v) {
+    /*
+     *      c                c
+     *     / \              /|\
+     *    a---b    ->      a-v-b
+     *     \ /              \|/
+     *      d                d
+     */
+    stamp++;
+    cavity.clear();
+    added.clear();
+
+    // work from the finite side
+    if(triangles[prev(e)] == INFINITE) e = halfedges[e];
+    uint32_t f = halfedges[e];
+    uint32_t t = e / 3, u = f / 3;
+    uint32_t a = triangles[e], b = triangles[next(e)], c = triangles[prev(e)], d = triangles[prev(f)];
+    uint32_t ca = halfedges[prev(e)], ad = halfedges[next(f)], db = halfedges[prev(f)], bc = halfedges[next(e)];
+
+    // t becomes (a, v, c) and u (b, v, d), the new triangles take the halves beyond v
+    triangles[3 * t] = a;
+    triangles[3 * t + 1] = v;
+    triangles[3 * t + 2] = c;
+    triangles[3 * u] = b;
+    triangles[3 * u + 1] = v;
+    triangles[3 * u + 2] = d;
+    uint32_t t1 = addTriangle(v, b, c), u1 = addTriangle(v, a, d);
+    for(uint32_t s : {t, u, t1, u1}) stamps[s] = stamp;
+    for(uint32_t s : {t, u}) {
+        cavity.push_back(s);
+        added.push_back(s);
+    }
+
+    auto link = [this](uint32_t e1, uint32_t e2) {
+        halfedges[e1] = e2;
+        halfedges[e2] = e1;
+    };
+    link(3 * t, 3 * u1);
+    link(3 * t + 1, 3 * t1 + 2);
+    link(3 * t + 2, ca);
+    link(3 * t1, 3 * u);
+    link(3 * t1 + 1, bc);
+    link(3 * u + 1, 3 * u1 + 2);
+    link(3 * u + 2, db);
+    link(3 * u1 + 1, ad);
+
+    vertexEdge[v] = 3 * t + 1;
+    vertexEdge[a] = 3 * t;
+    vertexEdge[b] = 3 * t1 + 1;
+    vertexEdge[c] = 3 * t + 2;
+    if(d != INFINITE) vertexEdge[d] = 3 * u + 2;
+    last = t;
+}
+
+template<typename K>
+void BasicTriangulation<K>::legalize() {
+    while(!pending.empty()) {
+        uint32_t e = pending.back();
+        pending.pop_back();
+
+        // hull edges stay, the hull does not change
+        uint32_t f = halfedges[e];
+        if(isGhost(e / 3) || isGhost(f / 3)) continue;
+
+        uint32_t a = triangles[e], b = triangles[next(e)], c = triangles[prev(e)], d = triangles[prev(f)];
+        if(incirclePerturbed<K>(point(a), point(b), point(c), point(d)) <= 0.) continue;
+
+        flip(e);
+        pending.push_back(3 * (e / 3));
+        pending.push_back(3 * (e / 3) + 1);
+        pending.push_back(3 * (f / 3));
+        pending.push_back(3 * (f / 3) + 1);
+    }
+}
+
+template<typename K>
+bool BasicTriangulation<K>::move(uint32_t v, double x, double y) {
+    cavity.clear();
+    added.clear();
+    if(v >= vertexEdge.size() || vertexEdge[v] == INVALID) return false;
+
+    // seen from inside every link edge the star stays a valid fan, which also keeps (x, y) off the
+    // other vertices and v off the hull
+    const double p[2] = {x, y};
+    uint32_t start = vertexEdge[v], e = start;
+    do {
+        uint32_t a = triangles[next(e)], b = triangles[prev(e)];
+        if(a == INFINITE || b == INFINITE || K::orient2d(point(a), point(b), p) <= 0.) return false;
+        e = halfedges[prev(e)];
+    } while(e != start);
+
+    coords[2 * v] = x;
+    coords[2 * v + 1] = y;
+
+    // only the spokes and the link edges can have lost the empty circle
+    stamp++;
+    pending.clear();
+    do {
+        pending.push_back(e);
+        pending.push_back(next(e));
+        e = halfedges[prev(e)];
+    } while(e != start);
+
+    legalize();
+    return true;
+}
+
+template<typename K>
+void BasicTriangulation<K>::getMesh(HalfEdgeMesh& mesh) const {
+    uint32_t count = 0;
+    std::vector<uint32_t> index(triangles.size() / 3, INVALID);
+    for(uint32_t t = 0; t < index.size(); ++t)
+        if(isAlive(t) && !isGhost(t)) index[t] = count++;
+
+    mesh.triangles.resize(3 * count);
+    mesh.halfedges.resize(3 * count);
+    for(uint32_t t = 0; t < index.size(); ++t) {
+        if(index[t] == INVALID) continue;
+
+        for(uint32_t i = 0; i < 3; ++i) {
+            uint32_t e = halfedges[3 * t + i];
+            mesh.triangles[3 * index[t] + i] = triangles[3 * t + i];
+            mesh.halfedges[3 * index[t] + i] = index[e / 3] == INVALID ? INVALID : 3 * index[e / 3] + e % 3;
+        }
+    }
+}
+
+template class BasicTriangulation<AdaptiveKernel>;
+template class BasicTriangulation<SnappedKernel>;
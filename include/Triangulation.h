@@ -0,0 +1,118 @@
+//
+// Created by lc06 on 4/18/2023.
+//
+
+#ifndef DELAUNAY_TRIANGULATION_H
+#define DELAUNAY_TRIANGULATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "HalfEdgeMesh.h"
+#include "Predicates.h"
+
+/*
+ * Incremental (Bowyer-Watson) Delaunay triangulation.
+ *
+ * Triangles are stored as flat half-edge arrays: half-edge e belongs to triangle e / 3 and runs
+ * from triangles[e] to triangles[next(e)], halfedges[e] is its twin. Every triangle is counterclockwise.
+ * The convex hull is closed with ghost triangles sharing the vertex INFINITE, so points outside the
+ * hull are inserted exactly like points inside it.
+ *
+ * K is the predicate kernel, AdaptiveKernel or SnappedKernel; both are instantiated in Triangulation.cpp.
+ * Triangulation is the adaptive one, which the hierarchy and the constrained triangulation build on.
+ */
+template<typename K>
+class BasicTriangulation {
+public:
+    static constexpr uint32_t INVALID = 0xFFFFFFFF;
+    static constexpr uint32_t INFINITE = 0xFFFFFFFE;
+
+    std::vector<double> coords;
+    std::vector<uint32_t> triangles;
+    std::vector<uint32_t> halfedges;
+    std::vector<uint32_t> vertexEdge;
+
+    BasicTriangulation() = default;
+    explicit BasicTriangulation(std::vector<double> _coords);
+
+    static uint32_t next(uint32_t e) { return e % 3 == 2 ? e - 2 : e + 1; }
+    static uint32_t prev(uint32_t e) { return e % 3 == 0 ? e + 2 : e - 1; }
+
+    uint32_t addVertex(double x, double y);
+    // take over a complete triangulation, ghost triangles included, built by other means
+    void adopt(std::vector<uint32_t> _triangles, std::vector<uint32_t> _halfedges);
+
+    // insert the vertices in the given order, returns the number of vertices actually inserted
+    uint32_t insert(const std::vector<uint32_t>& order);
+    // insert a single vertex, false if it duplicates an existing one; vertices arriving before the
+    // first non-degenerate triangle are held back until it exists
+    bool insert(uint32_t v, uint32_t hint = INVALID);
+    // take vertex v out and fill its star with Delaunay ears, false if v is not in the triangulation or
+    // the other vertices are all collinear, so that no finite triangle would be left anywhere
+    bool remove(uint32_t v);
+    // put vertex v at (x, y) and flip until the triangulation is Delaunay again; false, with nothing
+    // changed, unless (x, y) lies strictly inside the star of v and v is not on the hull
+    bool move(uint32_t v, double x, double y);
+    // replace the edge of half-edge e by the other diagonal of its quadrilateral, which must be convex;
+    // both triangles keep their slots
+    void flip(uint32_t e);
+    // put the new vertex v, which must lie strictly inside finite triangle t, in place of t with three
+    // triangles; no flips follow
+    void split(uint32_t t, uint32_t v);
+    // put the new vertex v, which must lie on the edge of half-edge e, in place of that edge with four
+    // triangles (two if the edge is on the hull); no flips follow
+    void splitEdge(uint32_t e, uint32_t v);
+    // triangles freed and triangles created by the last insert, remove, move or split, a slot may be in both
+    const std::vector<uint32_t>& lastRemoved() const { return cavity; }
+    const std::vector<uint32_t>& lastAdded() const { return added; }
+    // held back vertices that the insert creating the first triangle found to be repeats, they are in no triangle
+    const std::vector<uint32_t>& lastRepeats() const { return repeats; }
+
+    // triangle containing (x, y), or the ghost triangle whose outer half-plane contains it,
+    // walking from hint, from the last inserted triangle or, when neither is alive, from jump
+    uint32_t locate(double x, double y, uint32_t hint = INVALID);
+    // start triangle of the closest of ~sqrt(n) randomly sampled vertices
+    uint32_t jump(double x, double y);
+    // finite vertex of t closest to (x, y)
+    uint32_t nearestVertex(uint32_t t, double x, double y) const;
+
+    bool isGhost(uint32_t t) const {
+        return triangles[3 * t] == INFINITE || triangles[3 * t + 1] == INFINITE || triangles[3 * t + 2] == INFINITE;
+    }
+    bool isAlive(uint32_t t) const { return triangles[3 * t] != INVALID; }
+
+    // the finite triangles, compacted, with boundary twins set to INVALID
+    void getMesh(HalfEdgeMesh& mesh) const;
+
+private:
+    std::vector<uint32_t> freeTriangles;
+    std::vector<uint32_t> stamps;
+    uint32_t stamp {0};
+    uint32_t last {INVALID};
+    uint32_t seed {2463534242u};
+
+    std::vector<uint32_t> waiting;
+    std::vector<uint32_t> pending;
+    std::vector<uint32_t> cavity;
+    std::vector<uint32_t> boundary;
+    std::vector<uint32_t> added;
+    std::vector<uint32_t> repeats;
+    std::vector<uint32_t> ring;
+
+    const double* point(uint32_t v) const { return &coords[2 * v]; }
+
+    bool initialize(const std::vector<uint32_t>& order, std::vector<uint32_t>& skipped);
+    bool conflict(uint32_t t, const double* p) const;
+    bool ghostConflict(uint32_t a, uint32_t b, const double* p) const;
+    bool ear(const std::vector<uint32_t>& polygon, size_t i) const;
+    uint32_t addTriangle(uint32_t a, uint32_t b, uint32_t c);
+    void legalize();
+    uint32_t random();
+};
+
+using Triangulation = BasicTriangulation<AdaptiveKernel>;
+
+
+#endif //DELAUNAY_TRIANGULATION_H